@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "fileio.h"
+#include "matrix.h"
+#include "palindrome.h"
+#include "grades.h"
+#include "batch.h"
+
+// Input: "rows cols" followed by rows * cols integers. Output: "cols rows" followed by the transpose.
+static int batchTranspose(const char *path) {
+    IntReader reader;
+    if (intReaderOpen(&reader, path) < 0) {
+        return 1;
+    }
+
+    int rows, cols;
+    if (readInt(&reader, &rows) != 1 || readInt(&reader, &cols) != 1 || rows <= 0 || cols <= 0) {
+        fprintf(stderr, "Error: the input must start with the matrix size (rows cols).\n");
+        intReaderClose(&reader);
+        return 1;
+    }
+
+    int *matrix = createMatrix(rows, cols);
+    if (!matrix) {
+        fprintf(stderr, "Error: a %d x %d matrix does not fit in memory.\n", rows, cols);
+        intReaderClose(&reader);
+        return 1;
+    }
+
+    size_t total = (size_t)rows * cols;
+    for (size_t i = 0; i < total; i++) {
+        if (readInt(&reader, &matrix[i]) != 1) {
+            fprintf(stderr, "Error: expected %zu elements, element %zu is missing or not an integer.\n", total, i + 1);
+            intReaderClose(&reader);
+            freeMatrix(matrix);
+            return 1;
+        }
+    }
+
+    int extra, more = readInt(&reader, &extra); // The size must account for all of the input
+    intReaderClose(&reader);
+    if (more != 0) {
+        fprintf(stderr, "Error: the input has more than the %zu elements of a %d x %d matrix.\n", total, rows, cols);
+        freeMatrix(matrix);
+        return 1;
+    }
+
+    if (transposeMatrixInPlace(matrix, rows, cols, 0) < 0) {
+        fprintf(stderr, "Error: not enough memory to transpose.\n");
+        freeMatrix(matrix);
+        return 1;
+    }
+
+    static Writer writer;
+    writerInit(&writer, STDOUT_FILENO);
+    writeInt(&writer, cols);
+    writeChar(&writer, ' ');
+    writeInt(&writer, rows);
+    writeChar(&writer, '\n');
+    writeMatrix(&writer, matrix, cols, rows);
+    int status = writerFlush(&writer) < 0;
+
+    freeMatrix(matrix);
+    return status;
+}
+
+int runBatch(const char *operation, const char *path) {
+    if (strcmp(operation, "transpose") == 0) {
+        return batchTranspose(path);
+    }
+    if (strcmp(operation, "grades") == 0) {
+        return addGradesFromFile(path, 0) < 0;
+    }
+    if (strcmp(operation, "palindrome") == 0 || strcmp(operation, "palindrome-fold") == 0) {
+        return checkPalindromeFile(path, strcmp(operation, "palindrome-fold") == 0, 0) < 0;
+    }
+
+    fprintf(stderr, "Error: unknown operation \"%s\" (use grades, palindrome, palindrome-fold or transpose).\n", operation);
+    return 1;
+}
@@ -0,0 +1,7 @@
+#ifndef Batch_H
+#define Batch_H
+
+// Non-interactive mode: Main --batch <operation> [file]
+int runBatch(const char *operation, const char *path); // path "-" is stdin; returns the exit status
+
+#endif
@@ -0,0 +1,779 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "methods.h"
+#include "matrix.h"
+#include "palindrome.h"
+#include "grades.h"
+#include "fileio.h"
+
+#define MIN_BENCH_TIME 0.2  // Repeat each measurement for at least this many seconds
+#define PALINDROME_BENCH_SIZE (128u << 20)  // Bytes in each generated palindrome
+#define GRADES_BENCH_COUNT 20000000          // Grades in the generated input
+#define PARSE_BENCH_SIZE 2000                // Side of the matrix written out as text for the parser
+
+static int stackMatrix[100][100];
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void fillMatrix(int *matrix, size_t rows, size_t cols) {
+    for (size_t i = 0; i < rows * cols; i++) {
+        matrix[i] = (int)i;
+    }
+}
+
+// The current swap loop applied to a heap matrix, for sizes the int[][100] routine cannot take
+static void naiveTranspose(int *matrix, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = i + 1; j < n; j++) {
+            int temp = matrix[i * n + j];
+            matrix[i * n + j] = matrix[j * n + i];
+            matrix[j * n + i] = temp;
+        }
+    }
+}
+
+// Check that dst (cols x rows) is the transpose of src (rows x cols)
+static int isTransposed(const int *src, const int *dst, size_t rows, size_t cols) {
+    for (size_t i = 0; i < rows; i++) {
+        for (size_t j = 0; j < cols; j++) {
+            if (dst[j * rows + i] != src[i * cols + j]) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+// Shapes around the 8 / 64 boundaries, including single rows and columns, and past the
+// TRANSPOSE_STAGE_BYTES / TRANSPOSE_STREAM_BYTES sizes with odd (unaligned) row strides
+static const size_t checkShapes[][2] = {
+    {1, 1}, {1, 7}, {7, 1}, {3, 5}, {8, 8}, {9, 9}, {13, 29}, {29, 13}, {63, 65}, {65, 63},
+    {64, 64}, {67, 67}, {100, 37}, {37, 100}, {129, 129}, {130, 67}, {200, 200}, {257, 129},
+    {517, 601}, {601, 601}, {2101, 2050}, {2053, 2053},
+};
+
+// Transpose every shape through each entry point and compare with the element-wise definition
+static int checkTranspose(void) {
+    int threads[] = {1, 3, 0};
+    int failures = 0;
+
+    for (size_t s = 0; s < sizeof(checkShapes) / sizeof(checkShapes[0]); s++) {
+        size_t rows = checkShapes[s][0], cols = checkShapes[s][1];
+        int *src = createMatrix(rows, cols);
+        int *dst = createMatrix(cols, rows);
+        if (!src || !dst) {
+            printf("  %zu x %zu: out of memory\n", rows, cols);
+            freeMatrix(src);
+            freeMatrix(dst);
+            return failures + 1;
+        }
+
+        for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+            fillMatrix(src, rows, cols);
+            memset(dst, 0, rows * cols * sizeof(int));
+            transposeMatrixInto(src, dst, rows, cols, threads[t]);
+            if (!isTransposed(src, dst, rows, cols)) {
+                printf("  FAIL into %zu x %zu, %d threads\n", rows, cols, threads[t]);
+                failures++;
+            }
+
+            // Square tiles swap in place; other shapes go through the scratch copy
+            memcpy(dst, src, rows * cols * sizeof(int));
+            if (transposeMatrixInPlace(dst, rows, cols, threads[t]) != 0 || !isTransposed(src, dst, rows, cols)) {
+                printf("  FAIL in place %zu x %zu, %d threads\n", rows, cols, threads[t]);
+                failures++;
+            }
+        }
+
+        memcpy(dst, src, rows * cols * sizeof(int));
+        if (transposeMatrixCycles(dst, rows, cols) != 0 || !isTransposed(src, dst, rows, cols)) {
+            printf("  FAIL cycles %zu x %zu\n", rows, cols);
+            failures++;
+        }
+
+        freeMatrix(src);
+        freeMatrix(dst);
+    }
+
+    printf("  %zu shapes, %d failures\n", sizeof(checkShapes) / sizeof(checkShapes[0]), failures);
+    return failures;
+}
+
+// Print GB/s for one method: every element is read once and written once
+static void report(const char *name, size_t n, double seconds, int runs) {
+    double bytes = 2.0 * n * n * sizeof(int) * runs;
+    printf("  %-28s %9.3f ms  %7.2f GB/s\n", name, seconds / runs * 1e3, bytes / seconds / 1e9);
+}
+
+static void benchTranspose(size_t n) {
+    int *matrix = createMatrix(n, n);
+    int *out = createMatrix(n, n);
+    if (!matrix || !out) {
+        printf("n = %zu: out of memory\n", n);
+        freeMatrix(matrix);
+        freeMatrix(out);
+        return;
+    }
+
+    fillMatrix(matrix, n, n);
+    memset(out, 0, n * n * sizeof(int));
+    printf("n = %zu (%.1f MB)\n", n, n * n * sizeof(int) / 1e6);
+
+    double start;
+    int runs;
+
+    if (n <= 100) {
+        for (runs = 0, start = now(); now() - start < MIN_BENCH_TIME; runs++) {
+            transposeSquare(stackMatrix, (int)n);
+        }
+        report("transposeSquare int[][100]", n, now() - start, runs);
+    }
+
+    for (runs = 0, start = now(); now() - start < MIN_BENCH_TIME; runs++) {
+        naiveTranspose(matrix, n);
+    }
+    report("naive swap (heap)", n, now() - start, runs);
+
+    for (runs = 0, start = now(); now() - start < MIN_BENCH_TIME; runs++) {
+        transposeMatrixInPlace(matrix, n, n, 1);
+    }
+    report("blocked in place, 1 thread", n, now() - start, runs);
+
+    for (runs = 0, start = now(); now() - start < MIN_BENCH_TIME; runs++) {
+        transposeMatrixInPlace(matrix, n, n, 0);
+    }
+    report("blocked in place, all CPUs", n, now() - start, runs);
+
+    for (runs = 0, start = now(); now() - start < MIN_BENCH_TIME; runs++) {
+        transposeMatrixInto(matrix, out, n, n, 1);
+    }
+    report("blocked into, 1 thread", n, now() - start, runs);
+
+    for (runs = 0, start = now(); now() - start < MIN_BENCH_TIME; runs++) {
+        transposeMatrixInto(matrix, out, n, n, 0);
+    }
+    report("blocked into, all CPUs", n, now() - start, runs);
+
+    if (!isTransposed(matrix, out, n, n)) {
+        printf("  MISMATCH in blocked result\n");
+    }
+
+    freeMatrix(matrix);
+    freeMatrix(out);
+}
+
+// Print GB/s for a check that reads every byte of the input once
+static void reportScan(const char *name, size_t length, double seconds, int runs, int result) {
+    printf("  %-28s %9.3f ms  %7.2f GB/s  %s\n", name, seconds / runs * 1e3,
+           (double)length * runs / seconds / 1e9, result ? "palindrome" : "NOT a palindrome");
+}
+
+static void benchPalindrome(size_t length) {
+    char *exact = malloc(length);
+    char *text = malloc(length);
+    if (!exact || !text) {
+        printf("out of memory\n");
+        free(exact);
+        free(text);
+        return;
+    }
+
+    // A random palindrome, and one that is only a palindrome once case is ignored
+    const char symbols[] = "abcdefghijklmnopqrstuvwxyz0123456789 ,.!";
+    srand(1);
+    for (size_t i = 0; i < length / 2; i++) {
+        exact[i] = exact[length - 1 - i] = 'a' + rand() % 26;
+        char c = symbols[rand() % (sizeof(symbols) - 1)];
+        text[i] = c;
+        text[length - 1 - i] = (c >= 'a' && c <= 'z' && rand() % 2) ? c - 'a' + 'A' : c;
+    }
+    if (length % 2) {
+        exact[length / 2] = text[length / 2] = 'x';
+    }
+
+    printf("length = %zu (%.1f MB)\n", length, length / 1e6);
+
+    double start;
+    int runs, result = 0;
+
+    for (runs = 0, start = now(); now() - start < MIN_BENCH_TIME; runs++) {
+        result = palindromeBytes(exact, length);
+    }
+    reportScan("scalar bytes", length, now() - start, runs, result);
+
+    for (runs = 0, start = now(); now() - start < MIN_BENCH_TIME; runs++) {
+        result = isPalindromeRange(exact, length, 1);
+    }
+    reportScan("vector, 1 thread", length, now() - start, runs, result);
+
+    for (runs = 0, start = now(); now() - start < MIN_BENCH_TIME; runs++) {
+        result = isPalindromeRange(exact, length, 0);
+    }
+    reportScan("vector, all CPUs", length, now() - start, runs, result);
+
+    for (runs = 0, start = now(); now() - start < MIN_BENCH_TIME; runs++) {
+        result = isPalindromeFoldedScalar(text, length);
+    }
+    reportScan("folded scalar", length, now() - start, runs, result);
+
+    for (runs = 0, start = now(); now() - start < MIN_BENCH_TIME; runs++) {
+        result = isPalindromeFolded(text, length);
+    }
+    reportScan("folded vector", length, now() - start, runs, result);
+
+    free(exact);
+    free(text);
+}
+
+// isPalindromeRange at 1, 3 and all threads against the byte-by-byte reference
+static int checkRange(const char *text, size_t length, size_t flipped) {
+    int threads[] = {1, 3, 0};
+    int expected = palindromeBytes(text, length);
+
+    for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+        if (isPalindromeRange(text, length, threads[t]) != expected) {
+            printf("  FAIL range length %zu, byte %zu flipped, %d threads\n", length, flipped, threads[t]);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Random bytes mirrored around the middle
+static void fillPalindrome(char *text, size_t length) {
+    for (size_t i = 0; i < (length + 1) / 2; i++) {
+        text[i] = text[length - 1 - i] = (char)(rand() % 256);
+    }
+}
+
+// Every length up to 200 (across the 16 / 32 / 64 byte kernel blocks) with each byte flipped in turn,
+// lengths whose half crosses PALINDROME_CHUNK boundaries with bytes flipped at the block and chunk edges,
+// and the folded kernels against the two-pointer version on mixed-case, punctuated and >= 0x80 input.
+static int checkPalindrome(void) {
+    const size_t chunk = PALINDROME_CHUNK;
+    const size_t bigLengths[] = {2 * chunk - 1, 2 * chunk, 2 * chunk + 1, 2 * chunk + 63, 4 * chunk + 2, 6 * chunk + 3};
+    const size_t edges[] = {0, 1, 15, 16, 31, 32, 63, 64, chunk - 1, chunk, chunk + 1, 2 * chunk - 1, 2 * chunk};
+    char *text = malloc(6 * chunk + 3);
+    int failures = 0, palindromes = 0, folded = 0;
+
+    if (!text) {
+        printf("  out of memory\n");
+        return 1;
+    }
+    srand(5);
+
+    for (size_t length = 0; length <= 200; length++) {
+        fillPalindrome(text, length);
+        failures += checkRange(text, length, length);
+        for (size_t i = 0; i < length; i++) {
+            char saved = text[i];
+            text[i] ^= (char)(1 + rand() % 255);
+            failures += checkRange(text, length, i);
+            text[i] = saved;
+        }
+    }
+
+    for (size_t b = 0; b < sizeof(bigLengths) / sizeof(bigLengths[0]); b++) {
+        size_t length = bigLengths[b];
+        fillPalindrome(text, length);
+        failures += checkRange(text, length, length);
+        for (size_t e = 0; e < 2 * sizeof(edges) / sizeof(edges[0]); e++) {
+            size_t edge = edges[e / 2];
+            size_t i = e % 2 ? length - 1 - edge : edge; // The same distance from either end
+            if (edge >= length) {
+                continue;
+            }
+            char saved = text[i];
+            text[i] ^= (char)(1 + rand() % 255);
+            failures += checkRange(text, length, i);
+            text[i] = saved;
+        }
+    }
+
+    // Folded: a mirrored alphanumeric core with random case and noise between the characters, longer than
+    // FOLD_BUFFER in a quarter of the cases, and with one character changed in half of them
+    const char alnum[] = "abcdefghijklmnopqrstuvwxyz0123456789";
+    const char noise[] = " ,.!?-_@[`{/:\t\n";
+    for (int trial = 0; trial < 4000; trial++) {
+        size_t core = trial % 4 == 0 ? rand() % 20000 : rand() % 200;
+        size_t length = 0;
+        for (size_t k = 0; k < core; k++) {
+            size_t mirror = k < core - k ? k : core - 1 - k; // Same seed for k and its mirror
+            for (int extra = rand() % 3; extra > 0; extra--) {
+                text[length++] = rand() % 2 ? noise[rand() % (sizeof(noise) - 1)] : (char)(0x80 + rand() % 128);
+            }
+            char c = alnum[(mirror * 7919 + trial) % (sizeof(alnum) - 1)];
+            text[length++] = (c >= 'a' && rand() % 2) ? c - 'a' + 'A' : c;
+        }
+        if (length > 0 && rand() % 2) {
+            text[rand() % length] = alnum[rand() % (sizeof(alnum) - 1)];
+        }
+
+        int expected = isPalindromeFoldedScalar(text, length);
+        palindromes += expected;
+        folded++;
+        if (isPalindromeFolded(text, length) != expected) {
+            printf("  FAIL folded length %zu (expected %d)\n", length, expected);
+            failures++;
+        }
+    }
+
+    free(text);
+    printf("  exact lengths 0-200 and %zu chunk-sized, %d folded inputs (%d palindromes), %d failures\n",
+           sizeof(bigLengths) / sizeof(bigLengths[0]), folded, palindromes, failures);
+    return failures;
+}
+
+// The addGrades() approach on a buffer: parse into an array, then one pass for the avg and one for the grades above it
+static unsigned long long twoPassGrades(const char *text, int *grades, size_t capacity) {
+    size_t count = 0;
+    char *end;
+    long value;
+
+    while (count < capacity && (value = strtol(text, &end, 10), end != text)) {
+        grades[count++] = (int)value;
+        text = end;
+    }
+
+    double total = 0;
+    for (size_t i = 0; i < count; i++) {
+        total += grades[i];
+    }
+    double avg = total / count;
+
+    unsigned long long above = 0;
+    for (size_t i = 0; i < count; i++) {
+        above += grades[i] > avg;
+    }
+    return above;
+}
+
+// Grades strictly above the average, from the histogram
+static unsigned long long aboveAverage(const GradeStats *stats) {
+    double total = 0;
+    for (int g = 0; g < GRADE_RANGE; g++) {
+        total += (double)stats->histogram[g] * (g + GRADE_MIN);
+    }
+    double avg = total / stats->count;
+
+    unsigned long long above = 0;
+    for (int g = 0; g < GRADE_RANGE; g++) {
+        above += g + GRADE_MIN > avg ? stats->histogram[g] : 0;
+    }
+    return above;
+}
+
+static int benchGrades(size_t count) {
+    char *text = malloc(count * 4 + 1); // At most "100\n" per grade
+    int *grades = malloc(count * sizeof(int));
+    if (!text || !grades) {
+        printf("out of memory\n");
+        free(text);
+        free(grades);
+        return 1;
+    }
+
+    size_t length = 0;
+    srand(2);
+    for (size_t i = 0; i < count; i++) {
+        length += sprintf(text + length, "%d\n", rand() % (GRADE_MAX + 1));
+    }
+    printf("grades = %zu (%.1f MB)\n", count, length / 1e6);
+
+    double start;
+    int runs;
+    unsigned long long counted = 0;
+
+    for (runs = 0, start = now(); now() - start < MIN_BENCH_TIME; runs++) {
+        counted = twoPassGrades(text, grades, count);
+    }
+    printf("  %-28s %9.3f ms  %7.2f GB/s  (%llu above avg)\n", "strtol + two passes",
+           (now() - start) / runs * 1e3, (double)length * runs / (now() - start) / 1e9, counted);
+
+    const char *names[] = {"histogram, 1 thread", "histogram, all CPUs"};
+    int failures = 0;
+    for (int variant = 0; variant < 2; variant++) {
+        GradeStats stats;
+        for (runs = 0, start = now(); now() - start < MIN_BENCH_TIME; runs++) {
+            gradeStatsInit(&stats);
+            gradeStatsParse(&stats, text, length, variant == 0 ? 1 : 0);
+        }
+        double seconds = now() - start;
+        printf("  %-28s %9.3f ms  %7.2f GB/s  (%llu grades, median %d)\n", names[variant],
+               seconds / runs * 1e3, (double)length * runs / seconds / 1e9, stats.count,
+               gradeStatsPercentile(&stats, 0.5));
+        if (stats.count != count || aboveAverage(&stats) != counted) {
+            printf("  MISMATCH with the two-pass result\n");
+            failures++;
+        }
+    }
+
+    free(text);
+    free(grades);
+    return failures;
+}
+
+// Append one token and a random separator; grade < 0 means the token must be rejected
+static size_t appendGrade(char *text, size_t length, const char *token, int grade, GradeStats *expected) {
+    const char *separators[] = {" ", "\n", "\t", "\r\n", "  "};
+
+    length += sprintf(text + length, "%s%s", token, separators[rand() % 5]);
+    if (grade < 0) {
+        expected->rejected++;
+    } else {
+        expected->histogram[grade - GRADE_MIN]++;
+        expected->count++;
+    }
+    return length;
+}
+
+// Compare parsed statistics with the generated ones, bucket by bucket and through the percentiles
+static int checkGradeStats(const char *name, const GradeStats *got, const GradeStats *expected) {
+    const int percents[] = {1, 25, 50, 75, 90, 99, 100};
+
+    if (got->count != expected->count || got->rejected != expected->rejected) {
+        printf("  FAIL %s: %llu grades, %llu rejected (expected %llu, %llu)\n", name,
+               got->count, got->rejected, expected->count, expected->rejected);
+        return 1;
+    }
+    for (int g = 0; g < GRADE_RANGE; g++) {
+        if (got->histogram[g] != expected->histogram[g]) {
+            printf("  FAIL %s: %llu times %d (expected %llu)\n", name, got->histogram[g], g + GRADE_MIN,
+                   expected->histogram[g]);
+            return 1;
+        }
+    }
+    for (size_t p = 0; p < sizeof(percents) / sizeof(percents[0]); p++) {
+        unsigned long long seen = 0; // Nearest rank in integers: the first grade covering percent% of the count
+        int g = 0;
+        while ((seen += expected->histogram[g]) * 100 < (unsigned long long)percents[p] * expected->count) {
+            g++;
+        }
+        if (gradeStatsPercentile(got, percents[p] / 100.0) != g + GRADE_MIN) {
+            printf("  FAIL %s: p%d = %d (expected %d)\n", name, percents[p],
+                   gradeStatsPercentile(got, percents[p] / 100.0), g + GRADE_MIN);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Parse generated text whose histogram is known: tokens straddling the GRADES_CHUNK boundaries, rejected and
+// zero-padded tokens, and one token longer than GRADES_BLOCK. Mapped at 1, 3 and all threads, and streamed
+// from a pipe, which goes through the carry-over and overlong-token skip of the stdin path.
+static int checkGrades(void) {
+    static const struct {
+        const char *text;
+        int grade;  // -1: rejected
+    } special[] = {
+        {"3.5", -1}, {"1,90", -1}, {"101", -1}, {"-", -1}, {"+", -1}, {"-5", -1}, {"12a", -1}, {"85.", -1},
+        {"007", 7}, {"+0100", 100}, {"-0", 0}, {"+5", 5}, {"0000000000000000000000000000000000000000042", 42},
+    };
+    const size_t chunks = 3, overlong = 3 * GRADES_BLOCK + 17; // Spans several stream reads
+    char *text = malloc(chunks * GRADES_CHUNK + overlong + 4096);
+    GradeStats expected;
+    int failures = 0;
+
+    if (!text) {
+        printf("  out of memory\n");
+        return 1;
+    }
+    gradeStatsInit(&expected);
+    srand(4);
+
+    // Five grades, where each percentile's nearest rank falls on a different grade
+    GradeStats small, smallExpected;
+    gradeStatsInit(&small);
+    gradeStatsInit(&smallExpected);
+    size_t smallLength = 0;
+    for (int grade = 10; grade <= 50; grade += 10) {
+        char token[8];
+        sprintf(token, "%d", grade);
+        smallLength = appendGrade(text, smallLength, token, grade, &smallExpected);
+    }
+    gradeStatsParse(&small, text, smallLength, 1);
+    failures += checkGradeStats("five grades", &small, &smallExpected);
+
+    size_t length = 0;
+    for (size_t boundary = 1; boundary <= chunks; boundary++) {
+        size_t at = boundary * GRADES_CHUNK;
+        while (length + 64 < at) {
+            char token[16];
+            if (rand() % 5 == 0) {
+                size_t k = rand() % (sizeof(special) / sizeof(special[0]));
+                length = appendGrade(text, length, special[k].text, special[k].grade, &expected);
+            } else {
+                int grade = rand() % (GRADE_RANGE + 10) - 5 + GRADE_MIN; // A few just outside the range
+                sprintf(token, "%d", grade);
+                length = appendGrade(text, length, token, grade < GRADE_MIN || grade > GRADE_MAX ? -1 : grade,
+                                     &expected);
+            }
+        }
+        // Pad so the next token is cut by the boundary (a grade, then a rejected token) or starts on it
+        size_t offset = boundary == 1 ? 3 : boundary == 2 ? 2 : 0;
+        while (length < at - offset) {
+            text[length++] = ' ';
+        }
+        length = boundary == 1 ? appendGrade(text, length, "0000085", 85, &expected)
+               : boundary == 2 ? appendGrade(text, length, "1,90", -1, &expected)
+               : appendGrade(text, length, "64", 64, &expected);
+    }
+    memset(text + length, '7', overlong);
+    length += overlong;
+    text[length++] = '\n';
+    expected.rejected++;
+    length = appendGrade(text, length, "50", 50, &expected);
+
+    int threads[] = {1, 3, 0};
+    for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+        char name[32];
+        GradeStats got;
+        gradeStatsInit(&got);
+        gradeStatsParse(&got, text, length, threads[t]);
+        sprintf(name, "mapped, %d threads", threads[t]);
+        failures += checkGradeStats(name, &got, &expected);
+    }
+
+    int fds[2];
+    fflush(stdout);
+    if (pipe(fds) < 0) {
+        perror("pipe");
+        free(text);
+        return failures + 1;
+    }
+    pid_t writer = fork();
+    if (writer == 0) { // Feed the text through the pipe, in whatever pieces the kernel takes
+        close(fds[0]);
+        for (size_t done = 0; done < length;) {
+            ssize_t put = write(fds[1], text + done, length - done);
+            if (put <= 0) {
+                _exit(1);
+            }
+            done += put;
+        }
+        _exit(0);
+    }
+    close(fds[1]);
+
+    GradeStats got;
+    gradeStatsInit(&got);
+    int savedStdin = dup(STDIN_FILENO);
+    dup2(fds[0], STDIN_FILENO);
+    close(fds[0]);
+    int result = writer > 0 ? gradeStatsRead(&got, "-", 0) : -1;
+    dup2(savedStdin, STDIN_FILENO);
+    close(savedStdin);
+    clearerr(stdin);
+    if (writer > 0) {
+        waitpid(writer, NULL, 0);
+    }
+    if (result < 0) {
+        printf("  FAIL stdin: read error\n");
+        failures++;
+    } else {
+        failures += checkGradeStats("stdin", &got, &expected);
+    }
+
+    printf("  %.1f MB, %llu grades, %llu rejected, %d failures\n", length / 1e6, expected.count,
+           expected.rejected, failures);
+    free(text);
+    return failures;
+}
+
+// Time one run of a step that is too slow to repeat, with its throughput over the text size
+static void reportOnce(const char *name, size_t bytes, double seconds) {
+    printf("  %-28s %9.3f ms  %7.2f MB/s\n", name, seconds * 1e3, bytes / seconds / 1e6);
+}
+
+// readInt on single tokens: the int limits, overflow, signs and malformed input
+static int checkReadInt(void) {
+    static const struct {
+        const char *text;
+        int result;  // Expected readInt() return value
+        int value;   // Expected value when result is 1
+    } cases[] = {
+        {"2147483647", 1, INT_MAX}, {"-2147483648", 1, INT_MIN}, {"+2147483647", 1, INT_MAX},
+        {"2147483648", -1, 0}, {"-2147483649", -1, 0}, {"99999999999", -1, 0}, {"4294967296", -1, 0},
+        {"+0", 1, 0}, {"-0", 1, 0}, {"+42", 1, 42}, {"-42", 1, -42}, {" \t\r\n-7\n", 1, -7},
+        {"000000000000000000000000000000000000000000000000000000000000000000000000000000012", 1, 12},
+        {"-00000000000000000000000000000000000000000000000000000000000000000000002147483648", 1, INT_MIN},
+        {"+-5", -1, 0}, {"-", -1, 0}, {"+", -1, 0}, {"12x", -1, 0}, {"1.5", -1, 0}, {"", 0, 0}, {"  \n", 0, 0},
+    };
+    int failures = 0;
+
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        char path[] = "/tmp/checkXXXXXX";
+        int fd = mkstemp(path);
+        size_t length = strlen(cases[c].text);
+        if (fd < 0 || write(fd, cases[c].text, length) != (ssize_t)length) {
+            printf("  cannot create the input\n");
+            return failures + 1;
+        }
+        close(fd);
+
+        IntReader reader;
+        int value = 0, result = -2;
+        if (intReaderOpen(&reader, path) == 0) {
+            result = readInt(&reader, &value);
+            if (result == 1 && readInt(&reader, &value) != 0) { // Nothing may follow the one token
+                result = -2;
+            }
+            intReaderClose(&reader);
+        }
+        unlink(path);
+
+        if (result != cases[c].result || (result == 1 && value != cases[c].value)) {
+            printf("  FAIL readInt(\"%s\") = %d, value %d\n", cases[c].text, result, value);
+            failures++;
+        }
+    }
+
+    printf("  %zu readInt cases, %d failures\n", sizeof(cases) / sizeof(cases[0]), failures);
+    return failures;
+}
+
+static int benchParse(size_t n) {
+    char path[] = "/tmp/benchXXXXXX";
+    int fd = mkstemp(path);
+    FILE *out = fd >= 0 ? fdopen(fd, "w") : NULL;
+    int *matrix = createMatrix(n, n);
+    int *expected = createMatrix(n, n); // What scanf reads, to check the bulk reader against
+    if (!out || !matrix || !expected) {
+        printf("cannot create the input\n");
+        freeMatrix(matrix);
+        freeMatrix(expected);
+        return 1;
+    }
+
+    // A batch transpose input: "rows cols" and then the elements, some with an explicit '+'
+    srand(3);
+    fprintf(out, "%zu %zu\n", n, n);
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            fprintf(out, j % 7 == 3 ? "%+d " : "%d ", rand() % 2000001 - 1000000);
+        }
+        fprintf(out, "\n");
+    }
+    long bytes = ftell(out);
+    fclose(out);
+    printf("matrix = %zu x %zu (%.1f MB of text)\n", n, n, bytes / 1e6);
+
+    double start = now();
+    FILE *in = fopen(path, "r");
+    int rows = 0, cols = 0;
+    if (!in || fscanf(in, "%d %d", &rows, &cols) != 2) {
+        printf("cannot read the input\n");
+    }
+    for (size_t i = 0; in && i < n * n; i++) {
+        if (fscanf(in, "%d", &expected[i]) != 1) {
+            break;
+        }
+    }
+    if (in) {
+        fclose(in);
+    }
+    reportOnce("scanf(\"%d\")", bytes, now() - start);
+
+    IntReader reader;
+    int failures = 0;
+    memset(matrix, 0, n * n * sizeof(int));
+    start = now();
+    if (intReaderOpen(&reader, path) == 0) {
+        readInt(&reader, &rows);
+        readInt(&reader, &cols);
+        for (size_t i = 0; i < n * n; i++) {
+            if (readInt(&reader, &matrix[i]) != 1) {
+                printf("  parse error at element %zu\n", i);
+                break;
+            }
+        }
+        intReaderClose(&reader);
+    }
+    reportOnce("bulk reader", bytes, now() - start);
+    unlink(path);
+
+    if (rows != (int)n || cols != (int)n || memcmp(matrix, expected, n * n * sizeof(int)) != 0) {
+        printf("  MISMATCH between the bulk reader and scanf\n");
+        failures++;
+    }
+    freeMatrix(expected);
+
+    start = now();
+    transposeMatrixInPlace(matrix, n, n, 0);
+    reportOnce("transpose", bytes, now() - start);
+
+    FILE *null = fopen("/dev/null", "w");
+    start = now();
+    for (size_t i = 0; null && i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            fprintf(null, "%d ", matrix[i * n + j]);
+        }
+        fprintf(null, "\n");
+    }
+    reportOnce("printf per element", bytes, now() - start);
+    if (null) {
+        fclose(null);
+    }
+
+    static Writer writer;
+    writerInit(&writer, open("/dev/null", O_WRONLY));
+    start = now();
+    writeMatrix(&writer, matrix, n, n);
+    writerFlush(&writer);
+    reportOnce("buffered writer", bytes, now() - start);
+    close(writer.fd);
+
+    freeMatrix(matrix);
+    return failures;
+}
+
+// Runs every section, or only the ones named on the command line. Exits with 1 if a check failed.
+int main(int argc, char *argv[]) {
+    size_t transposeSizes[] = {100, 1000, 4096};
+    int failures = 0;
+
+    for (int i = 1; i < argc || i == 1; i++) {
+        const char *section = argc > 1 ? argv[i] : NULL;
+
+        if (!section || strcmp(section, "check") == 0) {
+            printf("--- Check transpose ---\n");
+            failures += checkTranspose();
+            printf("--- Check readInt ---\n");
+            failures += checkReadInt();
+            printf("--- Check palindrome ---\n");
+            failures += checkPalindrome();
+            printf("--- Check grades ---\n");
+            failures += checkGrades();
+        }
+        if (!section || strcmp(section, "transpose") == 0) {
+            printf("--- Transpose ---\n");
+            for (size_t j = 0; j < sizeof(transposeSizes) / sizeof(transposeSizes[0]); j++) {
+                benchTranspose(transposeSizes[j]);
+            }
+        }
+        if (!section || strcmp(section, "palindrome") == 0) {
+            printf("--- Palindrome ---\n");
+            benchPalindrome(PALINDROME_BENCH_SIZE);
+        }
+        if (!section || strcmp(section, "grades") == 0) {
+            printf("--- Grades ---\n");
+            failures += benchGrades(GRADES_BENCH_COUNT);
+        }
+        if (!section || strcmp(section, "parse") == 0) {
+            printf("--- Parse / print ---\n");
+            failures += benchParse(PARSE_BENCH_SIZE);
+        }
+    }
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,303 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "fileio.h"
+
+// Read a whole stream into a heap buffer (pipes cannot be mapped)
+static int readStream(int fd, MappedFile *file) {
+    size_t capacity = READ_BLOCK, length = 0;
+    char *data = malloc(capacity);
+
+    while (data) {
+        if (length == capacity) {
+            char *grown = realloc(data, capacity * 2);
+            if (!grown) {
+                break;
+            }
+            data = grown;
+            capacity *= 2;
+        }
+
+        ssize_t got = read(fd, data + length, capacity - length);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got < 0) {
+            perror("read");
+            free(data);
+            return -1;
+        }
+        if (got == 0) {
+            file->data = data;
+            file->length = length;
+            file->owned = 1;
+            return 0;
+        }
+        length += got;
+    }
+
+    perror("malloc");
+    free(data);
+    return -1;
+}
+
+int mapFile(const char *path, MappedFile *file) {
+    file->data = NULL;
+    file->length = 0;
+    file->owned = 0;
+
+    if (strcmp(path, "-") == 0) {
+        return readStream(STDIN_FILENO, file);
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        perror(path);
+        close(fd);
+        return -1;
+    }
+
+    if (st.st_size > 0) {
+        void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            perror(path);
+            close(fd);
+            return -1;
+        }
+        file->data = data;
+        file->length = st.st_size;
+    }
+
+    close(fd); // The mapping stays valid after the descriptor is closed
+    return 0;
+}
+
+void unmapFile(MappedFile *file) {
+    if (file->owned) {
+        free((void *)file->data);
+    } else if (file->data) {
+        munmap((void *)file->data, file->length);
+    }
+    file->data = NULL;
+    file->length = 0;
+}
+
+//------------------------------------------------------
+// bulk integer reader
+
+const unsigned char spaceTable[256] = {[' '] = 1, ['\n'] = 1, ['\t'] = 1, ['\r'] = 1};
+
+// Keep at least READ_LOOKAHEAD bytes after pos, or zero padding once the input is exhausted
+static int refill(IntReader *reader) {
+    if (reader->eof || reader->end - reader->pos >= READ_LOOKAHEAD) {
+        return 0;
+    }
+
+    memmove(reader->buffer, reader->buffer + reader->pos, reader->end - reader->pos);
+    reader->end -= reader->pos;
+    reader->pos = 0;
+
+    while (!reader->eof && reader->end < READ_BLOCK) {
+        ssize_t got = read(reader->fd, reader->buffer + reader->end, READ_BLOCK - reader->end);
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("read");
+            return -1;
+        }
+        if (got == 0) {
+            reader->eof = 1;
+            memset(reader->buffer + reader->end, 0, READ_LOOKAHEAD); // Lets the parser read past the end safely
+        }
+        reader->end += got;
+        if (reader->end - reader->pos >= READ_LOOKAHEAD) {
+            break;
+        }
+    }
+    return 0;
+}
+
+// Number of leading ASCII digits in the 8 bytes of chunk (SWAR: each byte must be 0x30-0x39)
+static inline int leadingDigits(uint64_t chunk) {
+    const uint64_t high = 0xF0F0F0F0F0F0F0F0ULL, zeros = 0x3030303030303030ULL;
+    uint64_t nonDigit = ((chunk & high) ^ zeros) | (((chunk + 0x0606060606060606ULL) & high) ^ zeros);
+    return nonDigit ? __builtin_ctzll(nonDigit) / 8 : 8;
+}
+
+// Value of 8 digit bytes (already minus '0', first digit in the lowest byte) with three multiplies
+static inline uint32_t eightDigits(uint64_t digits) {
+    digits = (digits * 10) + (digits >> 8);
+    digits = (((digits & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+              (((digits >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+    return (uint32_t)digits;
+}
+
+int intReaderOpen(IntReader *reader, const char *path) {
+    reader->fd = strcmp(path, "-") == 0 ? STDIN_FILENO : open(path, O_RDONLY);
+    if (reader->fd < 0) {
+        perror(path);
+        return -1;
+    }
+
+    reader->buffer = malloc(READ_BLOCK + READ_LOOKAHEAD);
+    if (!reader->buffer) {
+        perror("malloc");
+        intReaderClose(reader);
+        return -1;
+    }
+    reader->pos = reader->end = 0;
+    reader->eof = 0;
+    return 0;
+}
+
+int readInt(IntReader *reader, int *value) {
+    while (1) {
+        if (refill(reader) < 0) {
+            return -1;
+        }
+        while (reader->pos < reader->end && isSpace(reader->buffer[reader->pos])) {
+            reader->pos++;
+        }
+        if (reader->pos < reader->end && reader->end - reader->pos >= READ_LOOKAHEAD) {
+            break; // A token (if any) is fully buffered
+        }
+        if (reader->eof) {
+            if (reader->pos == reader->end) {
+                return 0;
+            }
+            break;
+        }
+    }
+
+    int negative = reader->buffer[reader->pos] == '-';
+    reader->pos += negative || reader->buffer[reader->pos] == '+';
+
+    // Leading zeros do not count towards the limit; consume them so refill() can bring in the rest of a long run
+    while (reader->buffer[reader->pos] == '0') {
+        if (refill(reader) < 0) {
+            return -1;
+        }
+        char next = reader->buffer[reader->pos + 1];
+        if (reader->pos + 1 >= reader->end || next < '0' || next > '9') {
+            break;
+        }
+        reader->pos++;
+    }
+
+    const char *p = reader->buffer + reader->pos;
+    const char *end = reader->buffer + reader->end;
+
+    long long result = 0;
+    int digits = 0, run;
+    do { // 8 digits per step; a token longer than the lookahead is rejected below
+        uint64_t chunk;
+        memcpy(&chunk, p, sizeof(chunk));
+        run = leadingDigits(chunk);
+        if (run > 0) {
+            uint64_t aligned = (chunk - 0x3030303030303030ULL) << (8 * (8 - run));
+            long long scale = 1;
+            for (int i = 0; i < run; i++) {
+                scale *= 10;
+            }
+            result = result * scale + eightDigits(aligned);
+            p += run;
+            digits += run;
+        }
+    } while (run == 8 && digits <= 10);
+
+    // Reject empty, too long or out of range numbers, trailing garbage, and tokens cut off by the lookahead
+    if (digits == 0 || digits > 10 || result > (long long)INT_MAX + negative ||
+        (p < end && !isSpace(*p)) || p > end || (p == end && !reader->eof)) {
+        return -1;
+    }
+
+    *value = (int)(negative ? -result : result);
+    reader->pos = p - reader->buffer;
+    return 1;
+}
+
+void intReaderClose(IntReader *reader) {
+    if (reader->fd > STDIN_FILENO) {
+        close(reader->fd);
+    }
+    free(reader->buffer);
+    reader->buffer = NULL;
+    reader->fd = -1;
+}
+
+//------------------------------------------------------
+// buffered writer
+
+void writerInit(Writer *writer, int fd) {
+    writer->fd = fd;
+    writer->used = 0;
+    writer->failed = 0;
+}
+
+// Flushes from writeChar/writeInt cannot report errors, so a failure sticks until the caller's final flush
+int writerFlush(Writer *writer) {
+    size_t done = 0;
+    while (!writer->failed && done < writer->used) {
+        ssize_t wrote = write(writer->fd, writer->buffer + done, writer->used - done);
+        if (wrote < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("write");
+            writer->failed = 1;
+            break;
+        }
+        done += wrote;
+    }
+    writer->used = 0;
+    return writer->failed ? -1 : 0;
+}
+
+void writeChar(Writer *writer, char c) {
+    if (writer->used == WRITE_BUFFER) {
+        writerFlush(writer);
+    }
+    writer->buffer[writer->used++] = c;
+}
+
+void writeString(Writer *writer, const char *str) {
+    while (*str) {
+        writeChar(writer, *str++);
+    }
+}
+
+void writeInt(Writer *writer, int value) {
+    char digits[12];
+    int n = 0;
+    unsigned magnitude = value < 0 ? 0u - (unsigned)value : (unsigned)value;
+
+    if (writer->used + sizeof(digits) > WRITE_BUFFER) {
+        writerFlush(writer);
+    }
+
+    do { // Digits come out last first
+        digits[n++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude);
+
+    if (value < 0) {
+        writer->buffer[writer->used++] = '-';
+    }
+    while (n > 0) {
+        writer->buffer[writer->used++] = digits[--n];
+    }
+}
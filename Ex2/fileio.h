@@ -0,0 +1,52 @@
+#ifndef FileIO_H
+#define FileIO_H
+
+#include <stddef.h>
+
+typedef struct {
+    const char *data;  // File contents (NULL for an empty file)
+    size_t length;     // Size in bytes
+    int owned;         // data was read into a heap buffer (stdin) instead of mapped
+} MappedFile;
+
+#define READ_BLOCK (1 << 20)    // Bytes read from the input at a time
+#define READ_LOOKAHEAD 64       // Bytes kept buffered ahead of the parser (longest token it reads unchecked)
+#define WRITE_BUFFER (1 << 16)  // Bytes collected before a write()
+
+typedef struct {
+    int fd;
+    char *buffer;  // READ_BLOCK + READ_LOOKAHEAD bytes
+    size_t pos;
+    size_t end;
+    int eof;
+} IntReader;
+
+typedef struct {
+    int fd;
+    size_t used;
+    int failed;  // A write() failed; later output is dropped and writerFlush() keeps returning -1
+    char buffer[WRITE_BUFFER];
+} Writer;
+
+// Token separators for readInt() and the grade parser, as a table so the per-byte test is one load
+extern const unsigned char spaceTable[256];
+
+static inline int isSpace(char c) {
+    return spaceTable[(unsigned char)c];
+}
+
+int mapFile(const char *path, MappedFile *file); // "-" reads all of stdin; 0 on success, -1 on failure (error printed)
+void unmapFile(MappedFile *file);
+
+int intReaderOpen(IntReader *reader, const char *path); // "-" reads stdin; 0 on success, -1 on failure
+// Reads the next whitespace-separated int: optional sign, any number of leading zeros, at most 10 further digits.
+int readInt(IntReader *reader, int *value); // 1 if a value was read, 0 at end of input, -1 on malformed input
+void intReaderClose(IntReader *reader);
+
+void writerInit(Writer *writer, int fd);
+void writeChar(Writer *writer, char c);
+void writeString(Writer *writer, const char *str);
+void writeInt(Writer *writer, int value);
+int writerFlush(Writer *writer); // 0 if everything written since writerInit reached fd, -1 otherwise
+
+#endif
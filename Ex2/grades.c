@@ -0,0 +1,245 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "fileio.h"
+#include "workers.h"
+#include "grades.h"
+
+typedef struct {
+    const char *data;
+    size_t length;
+    size_t nextChunk;  // Next GRADES_CHUNK to hand out (atomic)
+} GradeJob;
+
+typedef struct {
+    GradeJob *job;
+    GradeStats stats;  // Private histogram, merged once the thread is done
+} GradeWorker;
+
+static inline int isDigit(char c) {
+    return (unsigned char)(c - '0') <= 9;
+}
+
+// Count every token that starts in [lo, hi). A token that starts before lo belongs to the previous
+// range; one that starts before hi is finished even if it runs past hi. A token is a grade only if it
+// is a whole integer (optional sign, digits, nothing else); anything else is counted as rejected.
+static void parseGradeRange(GradeStats *stats, const char *data, size_t length, size_t lo, size_t hi) {
+    size_t i = lo;
+
+    if (i > 0 && !isSpace(data[i - 1])) {
+        while (i < length && !isSpace(data[i])) {
+            i++;
+        }
+    }
+
+    while (1) {
+        while (i < hi && isSpace(data[i])) {
+            i++;
+        }
+        if (i >= hi) {
+            break;
+        }
+
+        int negative = data[i] == '-';
+        i += negative || data[i] == '+';
+
+        size_t first = i;
+        while (i < length && data[i] == '0') { // Leading zeros do not count towards the digit limit
+            i++;
+        }
+        size_t significant = i;
+        unsigned value = 0;
+        while (i < length && isDigit(data[i])) {
+            value = value * 10 + (data[i] - '0');
+            i++;
+        }
+
+        if (i == first || (i < length && !isSpace(data[i]))) { // Not an integer: "3.5", "1,90", "-", "abc"
+            while (i < length && !isSpace(data[i])) {
+                i++;
+            }
+            stats->rejected++;
+            continue;
+        }
+
+        int grade = negative ? -(int)value : (int)value;
+        if (i - significant > 3 || grade < GRADE_MIN || grade > GRADE_MAX) { // Past 3 digits value may have wrapped
+            stats->rejected++;
+        } else {
+            stats->histogram[grade - GRADE_MIN]++;
+            stats->count++;
+        }
+    }
+}
+
+static void *gradeWorker(void *arg) {
+    GradeWorker *worker = arg;
+    GradeJob *job = worker->job;
+    size_t chunk;
+
+    while ((chunk = __atomic_fetch_add(&job->nextChunk, 1, __ATOMIC_RELAXED)) * (size_t)GRADES_CHUNK < job->length) {
+        size_t lo = chunk * GRADES_CHUNK;
+        size_t hi = job->length - lo < GRADES_CHUNK ? job->length : lo + GRADES_CHUNK;
+        parseGradeRange(&worker->stats, job->data, job->length, lo, hi);
+    }
+    return NULL;
+}
+
+void gradeStatsInit(GradeStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+}
+
+void gradeStatsMerge(GradeStats *into, const GradeStats *from) {
+    for (int g = 0; g < GRADE_RANGE; g++) {
+        into->histogram[g] += from->histogram[g];
+    }
+    into->count += from->count;
+    into->rejected += from->rejected;
+}
+
+void gradeStatsParse(GradeStats *stats, const char *data, size_t length, int threads) {
+    GradeJob job = {data, length, 0};
+    size_t chunks = (length + GRADES_CHUNK - 1) / GRADES_CHUNK;
+
+    threads = workerCount(threads, chunks);
+    GradeWorker *workers = calloc(threads, sizeof(GradeWorker));
+    if (!workers) { // Fall back to counting on this thread
+        parseGradeRange(stats, data, length, 0, length);
+        return;
+    }
+
+    for (int t = 0; t < threads; t++) {
+        workers[t].job = &job;
+    }
+    runWorkers(gradeWorker, workers, sizeof(GradeWorker), threads, chunks);
+    for (int t = 0; t < threads; t++) { // Workers that did not start have empty histograms
+        gradeStatsMerge(stats, &workers[t].stats);
+    }
+    free(workers);
+}
+
+int gradeStatsPercentile(const GradeStats *stats, double fraction) {
+    unsigned long long rank = (unsigned long long)ceil(fraction * stats->count);
+    unsigned long long seen = 0;
+
+    if (rank == 0) {
+        rank = 1;
+    }
+    for (int g = 0; g < GRADE_RANGE; g++) {
+        seen += stats->histogram[g];
+        if (seen >= rank) {
+            return g + GRADE_MIN;
+        }
+    }
+    return GRADE_MAX;
+}
+
+void gradeStatsPrint(const GradeStats *stats) {
+    printf("Counted %llu grades", stats->count);
+    if (stats->rejected) {
+        printf(" (%llu tokens ignored: not an integer in %d-%d)", stats->rejected, GRADE_MIN, GRADE_MAX);
+    }
+    printf("\n");
+    if (stats->count == 0) {
+        return;
+    }
+
+    double total = 0;
+    for (int g = 0; g < GRADE_RANGE; g++) {
+        total += (double)stats->histogram[g] * (g + GRADE_MIN);
+    }
+    double avg = total / stats->count;
+
+    double squares = 0;
+    for (int g = 0; g < GRADE_RANGE; g++) {
+        double diff = g + GRADE_MIN - avg;
+        squares += stats->histogram[g] * diff * diff;
+    }
+
+    printf("The avg grade is: %.2lf\n", avg);
+    printf("The standard deviation is: %.2lf\n", sqrt(squares / stats->count));
+    printf("Percentiles p25/p50/p75/p90/p99: %d/%d/%d/%d/%d\n",
+           gradeStatsPercentile(stats, 0.25), gradeStatsPercentile(stats, 0.50), gradeStatsPercentile(stats, 0.75),
+           gradeStatsPercentile(stats, 0.90), gradeStatsPercentile(stats, 0.99));
+
+    // Each distinct grade once, with how many students got it
+    unsigned long long above = 0;
+    printf("The grades that are above the avg are: ");
+    for (int g = 0; g < GRADE_RANGE; g++) {
+        if (stats->histogram[g] && g + GRADE_MIN > avg) {
+            printf("%d(x%llu) ", g + GRADE_MIN, stats->histogram[g]);
+            above += stats->histogram[g];
+        }
+    }
+    printf("\n%llu of %llu grades are above the avg\n", above, stats->count);
+}
+
+// Stream a descriptor through a fixed buffer, carrying a token cut at the block end over to the next read.
+// A token that fills the whole buffer is rejected and the rest of it skipped.
+static int parseGradeStream(GradeStats *stats, FILE *stream) {
+    static char buffer[GRADES_BLOCK];
+    size_t filled = 0, got;
+    int skipping = 0; // Inside an overlong token that was already counted
+
+    while ((got = fread(buffer + filled, 1, sizeof(buffer) - filled, stream)) > 0) {
+        size_t begin = 0;
+        filled += got;
+
+        if (skipping) {
+            while (begin < filled && !isSpace(buffer[begin])) {
+                begin++;
+            }
+            skipping = begin == filled;
+        }
+
+        size_t end = filled; // Only parse up to the last delimiter; the rest may continue in the next block
+        while (end > begin && !isSpace(buffer[end - 1])) {
+            end--;
+        }
+        if (end == begin && filled == sizeof(buffer) && begin == 0) { // No delimiter in a full buffer
+            stats->rejected++;
+            skipping = 1;
+            filled = 0;
+            continue;
+        }
+
+        parseGradeRange(stats, buffer, end, begin, end);
+        memmove(buffer, buffer + end, filled - end);
+        filled -= end;
+    }
+
+    if (ferror(stream)) {
+        perror("read");
+        return -1;
+    }
+    if (!skipping) {
+        parseGradeRange(stats, buffer, filled, 0, filled);
+    }
+    return 0;
+}
+
+int gradeStatsRead(GradeStats *stats, const char *path, int threads) {
+    if (strcmp(path, "-") == 0) {
+        return parseGradeStream(stats, stdin);
+    }
+
+    MappedFile file;
+    if (mapFile(path, &file) < 0) {
+        return -1;
+    }
+    gradeStatsParse(stats, file.data, file.length, threads);
+    unmapFile(&file);
+    return 0;
+}
+
+int addGradesFromFile(const char *path, int threads) {
+    GradeStats stats;
+    gradeStatsInit(&stats);
+
+    if (gradeStatsRead(&stats, path, threads) < 0) {
+        return -1;
+    }
+    gradeStatsPrint(&stats);
+    return 0;
+}
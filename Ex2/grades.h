@@ -0,0 +1,31 @@
+#ifndef Grades_H
+#define Grades_H
+
+#include <stddef.h>
+
+#define GRADE_MIN 0
+#define GRADE_MAX 100
+#define GRADE_RANGE (GRADE_MAX - GRADE_MIN + 1)
+#define GRADES_CHUNK (4 << 20)   // Bytes of a mapped file handed to a thread at a time
+#define GRADES_BLOCK (1 << 20)   // Bytes read from a stream at a time
+
+// Input format: tokens separated by spaces, tabs or newlines. A token is a grade if it is a whole
+// integer (optional '+' or '-', then digits only) in [GRADE_MIN, GRADE_MAX]. Every other token,
+// e.g. "3.5", "1,90", "id" or "101", is counted in rejected. On a stream, a token longer than
+// GRADES_BLOCK is rejected as well.
+
+typedef struct {
+    unsigned long long histogram[GRADE_RANGE]; // histogram[g - GRADE_MIN] = how many times g was seen
+    unsigned long long count;                  // Grades inside [GRADE_MIN, GRADE_MAX]
+    unsigned long long rejected;               // Tokens that are not an integer in the domain
+} GradeStats;
+
+void gradeStatsInit(GradeStats *stats);
+void gradeStatsMerge(GradeStats *into, const GradeStats *from);
+void gradeStatsParse(GradeStats *stats, const char *data, size_t length, int threads); // threads <= 0: one per CPU
+int gradeStatsPercentile(const GradeStats *stats, double fraction); // nearest-rank, fraction in (0, 1]
+void gradeStatsPrint(const GradeStats *stats);
+int gradeStatsRead(GradeStats *stats, const char *path, int threads); // "-" streams stdin; 0 on success, -1 on failure
+int addGradesFromFile(const char *path, int threads); // gradeStatsRead, then gradeStatsPrint
+
+#endif
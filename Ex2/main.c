@@ -1,16 +1,31 @@
 #include <stdio.h>
+#include <string.h>
 #include "methods.h"
+#include "matrix.h"
+#include "palindrome.h"
+#include "grades.h"
+#include "batch.h"
 
 #define N 4
 
-int main() {
+int main(int argc, char *argv[]) {
     int choice;
     int grades[N];
 
+    if (argc > 1) { // Non-interactive: Main --batch <operation> [file]
+        if (strcmp(argv[1], "--batch") != 0 || argc < 3 || argc > 4) {
+            fprintf(stderr, "Usage: %s [--batch grades|palindrome|palindrome-fold|transpose [file]]\n", argv[0]);
+            return 1;
+        }
+        return runBatch(argv[2], argc == 4 ? argv[3] : "-");
+    }
+
     printf("Choose a function to run:\n");
     printf("1. Add Grades\n");
     printf("2. Check Palindrome\n");
     printf("3. Transpose Matrix\n");
+    printf("4. Check Palindrome in File\n");
+    printf("5. Grade Statistics from File\n");
     printf("Enter your choice: ");
     scanf("%d", &choice);
 
@@ -31,27 +46,55 @@ int main() {
             printf("Enter the size of the matrix (n x n): ");
             scanf("%d", &n);
 
-            if (n > 100) {
-                printf("Matrix size is too large (max 100).\n");
+            if (n <= 0) {
+                printf("Matrix size must be positive.\n");
+                break;
+            }
+
+            int *matrix = createMatrix(n, n);
+            if (!matrix) {
+                printf("Matrix size is too large.\n");
                 break;
             }
 
-            int matrix[100][100];
             printf("Enter the elements of the matrix:\n");
             for (int i = 0; i < n; i++) {
                 for (int j = 0; j < n; j++) {
-                    scanf("%d", &matrix[i][j]);
+                    scanf("%d", &matrix[(size_t)i * n + j]);
                 }
             }
 
-            transposeMatrix(matrix, n);
+            printf("Matrix before transposition:\n");
+            printMatrixN(matrix, n, n);
+            transposeMatrixInPlace(matrix, n, n, 0);
+            printf("Matrix after transposition:\n");
+            printMatrixN(matrix, n, n);
+            freeMatrix(matrix);
             break;
+        }
+
+        case 4: {
+            char path[256];
+            char fold;
+            printf("Enter the path of the file to check: ");
+            scanf("%255s", path);
+            printf("Ignore case and non-alphanumeric characters? (y/n): ");
+            scanf(" %c", &fold);
+            checkPalindromeFile(path, fold == 'y' || fold == 'Y', 0);
+            break;
+        }
+
+        case 5: {
+            char path[256];
+            printf("Enter the path of the grades file (- for stdin): ");
+            scanf("%255s", path);
+            addGradesFromFile(path, 0);
+            break;
+        }
 
         default:
-            printf("Invalid choice. Please select 1 or 2.\n");
+            printf("Invalid choice. Please select 1 to 5.\n");
     }
 
-}
-
     return 0;
 }
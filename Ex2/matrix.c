@@ -0,0 +1,339 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "fileio.h"
+#include "workers.h"
+#include "matrix.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_SIMD 1
+#endif
+
+// Transposes an h x w block of src (row stride srcStride) into a w x h block of dst (row stride dstStride)
+typedef void (*BlockKernel)(const int *src, size_t srcStride, int *dst, size_t dstStride, size_t h, size_t w);
+
+typedef struct {
+    const int *src;
+    int *dst;
+    size_t rows;
+    size_t cols;
+    size_t bands;        // Number of TILE_SIZE bands to hand out
+    size_t nextBand;     // Next band to hand out (atomic)
+    int inPlace;         // Square in-place transpose (src == dst)
+    int staged;          // Out of place: go through the tile buffer (dst larger than L2)
+    int stream;          // Out of place: write dst with non-temporal stores (dst larger than the cache)
+    BlockKernel kernel;
+} TransposeJob;
+
+//------------------------------------------------------
+// block kernels
+
+// Scalar copy of the part of an h x w block that is not covered by the full hFull x wFull SIMD blocks
+static void transposeEdges(const int *src, size_t ss, int *dst, size_t ds, size_t h, size_t w, size_t hFull, size_t wFull) {
+    for (size_t i = 0; i < hFull; i++) {
+        for (size_t j = wFull; j < w; j++) {
+            dst[j * ds + i] = src[i * ss + j];
+        }
+    }
+    for (size_t i = hFull; i < h; i++) {
+        for (size_t j = 0; j < w; j++) {
+            dst[j * ds + i] = src[i * ss + j];
+        }
+    }
+}
+
+#ifndef HAVE_X86_SIMD
+static void transposeBlockScalar(const int *src, size_t ss, int *dst, size_t ds, size_t h, size_t w) {
+    transposeEdges(src, ss, dst, ds, h, w, 0, 0);
+}
+#else
+static inline void transpose4x4SSE(const int *src, size_t ss, int *dst, size_t ds) {
+    __m128i r0 = _mm_loadu_si128((const __m128i *)(src));
+    __m128i r1 = _mm_loadu_si128((const __m128i *)(src + ss));
+    __m128i r2 = _mm_loadu_si128((const __m128i *)(src + 2 * ss));
+    __m128i r3 = _mm_loadu_si128((const __m128i *)(src + 3 * ss));
+
+    __m128i t0 = _mm_unpacklo_epi32(r0, r1); // a0 b0 a1 b1
+    __m128i t1 = _mm_unpacklo_epi32(r2, r3); // c0 d0 c1 d1
+    __m128i t2 = _mm_unpackhi_epi32(r0, r1); // a2 b2 a3 b3
+    __m128i t3 = _mm_unpackhi_epi32(r2, r3); // c2 d2 c3 d3
+
+    _mm_storeu_si128((__m128i *)(dst), _mm_unpacklo_epi64(t0, t1));
+    _mm_storeu_si128((__m128i *)(dst + ds), _mm_unpackhi_epi64(t0, t1));
+    _mm_storeu_si128((__m128i *)(dst + 2 * ds), _mm_unpacklo_epi64(t2, t3));
+    _mm_storeu_si128((__m128i *)(dst + 3 * ds), _mm_unpackhi_epi64(t2, t3));
+}
+
+static void transposeBlockSSE(const int *src, size_t ss, int *dst, size_t ds, size_t h, size_t w) {
+    size_t hFull = h & ~(size_t)3, wFull = w & ~(size_t)3;
+
+    for (size_t i = 0; i < hFull; i += 4) {
+        for (size_t j = 0; j < wFull; j += 4) {
+            transpose4x4SSE(src + i * ss + j, ss, dst + j * ds + i, ds);
+        }
+    }
+    transposeEdges(src, ss, dst, ds, h, w, hFull, wFull);
+}
+
+__attribute__((target("avx2")))
+static inline void transpose8x8AVX2(const int *src, size_t ss, int *dst, size_t ds) {
+    __m256i r0 = _mm256_loadu_si256((const __m256i *)(src));
+    __m256i r1 = _mm256_loadu_si256((const __m256i *)(src + ss));
+    __m256i r2 = _mm256_loadu_si256((const __m256i *)(src + 2 * ss));
+    __m256i r3 = _mm256_loadu_si256((const __m256i *)(src + 3 * ss));
+    __m256i r4 = _mm256_loadu_si256((const __m256i *)(src + 4 * ss));
+    __m256i r5 = _mm256_loadu_si256((const __m256i *)(src + 5 * ss));
+    __m256i r6 = _mm256_loadu_si256((const __m256i *)(src + 6 * ss));
+    __m256i r7 = _mm256_loadu_si256((const __m256i *)(src + 7 * ss));
+
+    // Interleave 32-bit pairs: a0 b0 a1 b1 | a4 b4 a5 b5, ...
+    __m256i t0 = _mm256_unpacklo_epi32(r0, r1);
+    __m256i t1 = _mm256_unpackhi_epi32(r0, r1);
+    __m256i t2 = _mm256_unpacklo_epi32(r2, r3);
+    __m256i t3 = _mm256_unpackhi_epi32(r2, r3);
+    __m256i t4 = _mm256_unpacklo_epi32(r4, r5);
+    __m256i t5 = _mm256_unpackhi_epi32(r4, r5);
+    __m256i t6 = _mm256_unpacklo_epi32(r6, r7);
+    __m256i t7 = _mm256_unpackhi_epi32(r6, r7);
+
+    // Interleave 64-bit pairs: a0 b0 c0 d0 | a4 b4 c4 d4, ...
+    __m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+    __m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+    __m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+    __m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+    __m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+    __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+    __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+    __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+
+    // Combine 128-bit lanes into full columns
+    _mm256_storeu_si256((__m256i *)(dst), _mm256_permute2x128_si256(u0, u4, 0x20));
+    _mm256_storeu_si256((__m256i *)(dst + ds), _mm256_permute2x128_si256(u1, u5, 0x20));
+    _mm256_storeu_si256((__m256i *)(dst + 2 * ds), _mm256_permute2x128_si256(u2, u6, 0x20));
+    _mm256_storeu_si256((__m256i *)(dst + 3 * ds), _mm256_permute2x128_si256(u3, u7, 0x20));
+    _mm256_storeu_si256((__m256i *)(dst + 4 * ds), _mm256_permute2x128_si256(u0, u4, 0x31));
+    _mm256_storeu_si256((__m256i *)(dst + 5 * ds), _mm256_permute2x128_si256(u1, u5, 0x31));
+    _mm256_storeu_si256((__m256i *)(dst + 6 * ds), _mm256_permute2x128_si256(u2, u6, 0x31));
+    _mm256_storeu_si256((__m256i *)(dst + 7 * ds), _mm256_permute2x128_si256(u3, u7, 0x31));
+}
+
+__attribute__((target("avx2")))
+static void transposeBlockAVX2(const int *src, size_t ss, int *dst, size_t ds, size_t h, size_t w) {
+    size_t hFull = h & ~(size_t)7, wFull = w & ~(size_t)7;
+
+    for (size_t i = 0; i < hFull; i += 8) {
+        for (size_t j = 0; j < wFull; j += 8) {
+            transpose8x8AVX2(src + i * ss + j, ss, dst + j * ds + i, ds);
+        }
+    }
+    transposeEdges(src, ss, dst, ds, h, w, hFull, wFull);
+}
+#endif
+
+static BlockKernel blockKernel;
+static pthread_once_t blockKernelOnce = PTHREAD_ONCE_INIT; // Callers may run on several threads at once
+
+// Pick the widest kernel the CPU supports
+static void initBlockKernel(void) {
+#ifdef HAVE_X86_SIMD
+    __builtin_cpu_init();
+    blockKernel = __builtin_cpu_supports("avx2") ? transposeBlockAVX2 : transposeBlockSSE;
+#else
+    blockKernel = transposeBlockScalar;
+#endif
+}
+
+static BlockKernel selectKernel(void) {
+    pthread_once(&blockKernelOnce, initBlockKernel);
+    return blockKernel;
+}
+
+//------------------------------------------------------
+// tile scheduler
+
+// Copy count ints to dst without reading its cache lines first (no write-allocate). dst is not
+// read back until the whole transpose is done, by which time a large result would be evicted anyway.
+static void streamRow(int *dst, const int *src, size_t count) {
+#ifdef HAVE_X86_SIMD
+    size_t k = 0;
+    for (; k < count && ((uintptr_t)(dst + k) & 15); k++) {
+        dst[k] = src[k];
+    }
+    for (; k + 4 <= count; k += 4) {
+        _mm_stream_si128((__m128i *)(dst + k), _mm_loadu_si128((const __m128i *)(src + k)));
+    }
+    for (; k < count; k++) {
+        dst[k] = src[k];
+    }
+#else
+    memcpy(dst, src, count * sizeof(int));
+#endif
+}
+
+// Out of place: band t is the TILE_SIZE-column strip of src that becomes rows of dst.
+// Once dst no longer fits in L2, each tile is transposed into the local buffer first, so the
+// kernel's strided stores stay in L1, and is then written out as whole dst row segments.
+static void transposeBandInto(TransposeJob *job, size_t t, int *buffer) {
+    size_t j0 = t * TILE_SIZE;
+    size_t w = job->cols - j0 < TILE_SIZE ? job->cols - j0 : TILE_SIZE;
+
+    for (size_t i0 = 0; i0 < job->rows; i0 += TILE_SIZE) {
+        size_t h = job->rows - i0 < TILE_SIZE ? job->rows - i0 : TILE_SIZE;
+        int *dst = job->dst + j0 * job->rows + i0;
+
+        if (!job->staged) {
+            job->kernel(job->src + i0 * job->cols + j0, job->cols, dst, job->rows, h, w);
+            continue;
+        }
+
+        job->kernel(job->src + i0 * job->cols + j0, job->cols, buffer, TILE_SIZE, h, w);
+        for (size_t r = 0; r < w; r++, dst += job->rows) {
+            if (job->stream) {
+                streamRow(dst, buffer + r * TILE_SIZE, h);
+            } else {
+                memcpy(dst, buffer + r * TILE_SIZE, h * sizeof(int));
+            }
+        }
+    }
+}
+
+// Square in place: swap-transpose tile (t, J) with tile (J, t) for every J >= t
+static void transposeBandInPlace(TransposeJob *job, size_t t, int *buffer) {
+    int *m = job->dst;
+    size_t n = job->rows;
+    size_t i0 = t * TILE_SIZE;
+    size_t h = n - i0 < TILE_SIZE ? n - i0 : TILE_SIZE;
+
+    for (size_t j0 = i0; j0 < n; j0 += TILE_SIZE) {
+        size_t w = n - j0 < TILE_SIZE ? n - j0 : TILE_SIZE;
+
+        job->kernel(m + i0 * n + j0, n, buffer, TILE_SIZE, h, w); // (t, J) -> buffer
+        if (j0 != i0) {
+            job->kernel(m + j0 * n + i0, n, m + i0 * n + j0, n, w, h); // (J, t) -> (t, J)
+        }
+        for (size_t r = 0; r < w; r++) { // buffer -> (J, t)
+            memcpy(m + (j0 + r) * n + i0, buffer + r * TILE_SIZE, h * sizeof(int));
+        }
+    }
+}
+
+static void *transposeWorker(void *arg) {
+    TransposeJob *job = arg;
+    int buffer[TILE_SIZE * TILE_SIZE] __attribute__((aligned(MATRIX_ALIGN)));
+    size_t t;
+
+    while ((t = __atomic_fetch_add(&job->nextBand, 1, __ATOMIC_RELAXED)) < job->bands) {
+        if (job->inPlace) {
+            transposeBandInPlace(job, t, buffer);
+        } else {
+            transposeBandInto(job, t, buffer);
+        }
+    }
+#ifdef HAVE_X86_SIMD
+    if (job->stream) {
+        _mm_sfence(); // Non-temporal stores must be visible before the join
+    }
+#endif
+    return NULL;
+}
+
+//------------------------------------------------------
+// in place rectangular fallback
+
+// Follow the permutation cycles p -> p * rows mod (N - 1); needs only one bit per element
+int transposeMatrixCycles(int *matrix, size_t rows, size_t cols) {
+    size_t total = rows * cols;
+    unsigned char *visited = calloc((total + 7) / 8, 1);
+    if (!visited) {
+        return -1;
+    }
+
+    for (size_t start = 1; start + 1 < total; start++) {
+        if (visited[start / 8] & (1u << (start % 8))) {
+            continue;
+        }
+
+        size_t p = start;
+        int value = matrix[start];
+        do {
+            size_t next = (size_t)(((unsigned long long)p * rows) % (total - 1));
+            int temp = matrix[next];
+            matrix[next] = value;
+            value = temp;
+            visited[next / 8] |= 1u << (next % 8);
+            p = next;
+        } while (p != start);
+    }
+
+    free(visited);
+    return 0;
+}
+
+//------------------------------------------------------
+// public API
+
+int *createMatrix(size_t rows, size_t cols) {
+    if (rows == 0 || cols == 0 || rows > SIZE_MAX / sizeof(int) / cols) {
+        return NULL;
+    }
+
+    size_t bytes = rows * cols * sizeof(int);
+    void *matrix = NULL;
+    if (posix_memalign(&matrix, MATRIX_ALIGN, bytes) != 0) {
+        return NULL;
+    }
+    return matrix;
+}
+
+void freeMatrix(int *matrix) {
+    free(matrix);
+}
+
+void writeMatrix(Writer *writer, const int *matrix, size_t rows, size_t cols) {
+    for (size_t i = 0; i < rows; i++) {
+        for (size_t j = 0; j < cols; j++) {
+            writeInt(writer, matrix[i * cols + j]);
+            writeChar(writer, ' ');
+        }
+        writeChar(writer, '\n');
+    }
+}
+
+void printMatrixN(const int *matrix, size_t rows, size_t cols) {
+    static Writer writer;
+
+    fflush(stdout); // Keep the order with earlier printf output
+    writerInit(&writer, STDOUT_FILENO);
+    writeMatrix(&writer, matrix, rows, cols);
+    writerFlush(&writer);
+}
+
+void transposeMatrixInto(const int *src, int *dst, size_t rows, size_t cols, int threads) {
+    size_t bytes = rows * cols * sizeof(int);
+    TransposeJob job = {src, dst, rows, cols, (cols + TILE_SIZE - 1) / TILE_SIZE, 0, 0,
+                        bytes >= TRANSPOSE_STAGE_BYTES, bytes >= TRANSPOSE_STREAM_BYTES, selectKernel()};
+    runWorkers(transposeWorker, &job, 0, threads, job.bands);
+}
+
+int transposeMatrixInPlace(int *matrix, size_t rows, size_t cols, int threads) {
+    if (rows == cols) {
+        TransposeJob job = {matrix, matrix, rows, cols, (rows + TILE_SIZE - 1) / TILE_SIZE, 0, 1, 0, 0, selectKernel()};
+        runWorkers(transposeWorker, &job, 0, threads, job.bands);
+        return 0;
+    }
+
+    // Rectangular: go through a scratch copy when memory allows, otherwise follow cycles
+    int *scratch = createMatrix(cols, rows);
+    if (!scratch) {
+        return transposeMatrixCycles(matrix, rows, cols);
+    }
+
+    transposeMatrixInto(matrix, scratch, rows, cols, threads);
+    memcpy(matrix, scratch, rows * cols * sizeof(int));
+    freeMatrix(scratch);
+    return 0;
+}
@@ -0,0 +1,22 @@
+#ifndef Matrix_H
+#define Matrix_H
+
+#include <stddef.h>
+#include "fileio.h"
+
+#define TILE_SIZE 64      // Side of the square tiles the transpose works on (64x64 ints = 16KB)
+#define MATRIX_ALIGN 64   // Alignment of heap matrices (one cache line)
+#define TRANSPOSE_STAGE_BYTES (1u << 20)    // Out-of-place results at least this large are staged per tile
+#define TRANSPOSE_STREAM_BYTES (16u << 20)  // ... and at least this large bypass the cache
+
+int *createMatrix(size_t rows, size_t cols); // rows x cols ints, row-major, free with freeMatrix
+void freeMatrix(int *matrix);
+void printMatrixN(const int *matrix, size_t rows, size_t cols); // through one buffered writer on stdout
+void writeMatrix(Writer *writer, const int *matrix, size_t rows, size_t cols);
+
+// threads <= 0 means one thread per online CPU
+void transposeMatrixInto(const int *src, int *dst, size_t rows, size_t cols, int threads); // dst is cols x rows
+int transposeMatrixInPlace(int *matrix, size_t rows, size_t cols, int threads); // 0 on success, -1 on failure
+int transposeMatrixCycles(int *matrix, size_t rows, size_t cols); // single-threaded, needs one bit per element
+
+#endif
@@ -26,19 +26,25 @@ void addGrades(int grades[], int size) {
 
 //--------------------------------------------------------
 // ex2
-int isPalindrome(const char *str) {
-    int length = strlen(str);
-    int left = 0;
-    int right = length - 1;
+int palindromeBytes(const char *str, size_t length) {
+    size_t left = 0;
+    size_t right = length;
 
-    while (left < right) {
-        if (str[left] != str[right]) {
-            printf("\"%s\" is not a palindrome.\n", str);
-            return 0; 
+    while (left + 1 < right) {
+        if (str[left] != str[right - 1]) {
+            return 0;
         }
         left++;
         right--;
     }
+    return 1;
+}
+
+int isPalindrome(const char *str) {
+    if (!palindromeBytes(str, strlen(str))) {
+        printf("\"%s\" is not a palindrome.\n", str);
+        return 0; 
+    }
 
     printf("\"%s\" is a palindrome.\n", str);
     return 1; 
@@ -54,10 +60,7 @@ void printMatrix(int matrix[][100], int n) {
     }
 }
 
-void transposeMatrix(int matrix[][100], int n) {
-    printf("Matrix before transposition:\n");
-    printMatrix(matrix, n);
-
+void transposeSquare(int matrix[][100], int n) {
     for (int i = 0; i < n; i++) {
         for (int j = i + 1; j < n; j++) {
             int temp = matrix[i][j];
@@ -65,6 +68,13 @@ void transposeMatrix(int matrix[][100], int n) {
             matrix[j][i] = temp;
         }
     }
+}
+
+void transposeMatrix(int matrix[][100], int n) {
+    printf("Matrix before transposition:\n");
+    printMatrix(matrix, n);
+
+    transposeSquare(matrix, n);
 
     printf("Matrix after transposition:\n");
     printMatrix(matrix, n);
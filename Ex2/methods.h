@@ -1,9 +1,13 @@
 #ifndef Methods_H
 #define Methods_H
 
+#include <stddef.h>
+
 void addGrades(int grades[], int size); // ex1
 int isPalindrome(const char *str); // ex2
+int palindromeBytes(const char *str, size_t length); // ex2, byte-by-byte check without printing
 void transposeMatrix(int matrix[][100], int n); // ex3
+void transposeSquare(int matrix[][100], int n); // ex3, swap loop without printing
 
 
 #endif
\ No newline at end of file
@@ -0,0 +1,384 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include "methods.h"
+#include "fileio.h"
+#include "workers.h"
+#include "palindrome.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_SIMD 1
+#endif
+
+// Compares byte i with byte length - 1 - i for every i in [lo, hi), hi <= length / 2. Returns 1 if all match.
+typedef int (*RangeKernel)(const unsigned char *data, size_t length, size_t lo, size_t hi);
+
+typedef struct {
+    unsigned char chars[FOLD_BUFFER]; // Normalized characters, in the order they are compared
+    size_t count;
+    size_t pos;
+} FoldBuffer;
+
+// Fills a FoldBuffer from one end of data[front, back) and moves that end inwards
+typedef void (*FoldKernel)(const unsigned char *data, size_t *front, size_t *back, FoldBuffer *out);
+
+typedef struct {
+    const unsigned char *data;
+    size_t length;
+    size_t half;        // Number of byte pairs to compare
+    size_t nextChunk;   // Next PALINDROME_CHUNK to hand out (atomic)
+    int mismatch;       // Set by the first thread that finds a difference (atomic)
+    RangeKernel kernel;
+} PalindromeJob;
+
+//------------------------------------------------------
+// exact comparison kernels
+
+static int rangeScalar(const unsigned char *data, size_t length, size_t lo, size_t hi) {
+    for (size_t i = lo; i < hi; i++) {
+        if (data[i] != data[length - 1 - i]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+#ifdef HAVE_X86_SIMD
+__attribute__((target("ssse3")))
+static int rangeSSSE3(const unsigned char *data, size_t length, size_t lo, size_t hi) {
+    const __m128i reverse = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    size_t i = lo;
+
+    for (; i + 16 <= hi; i += 16) {
+        __m128i front = _mm_loadu_si128((const __m128i *)(data + i));
+        __m128i back = _mm_loadu_si128((const __m128i *)(data + length - i - 16));
+        back = _mm_shuffle_epi8(back, reverse);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(front, back)) != 0xFFFF) {
+            return 0;
+        }
+    }
+    return rangeScalar(data, length, i, hi);
+}
+
+// Reverse the 32 bytes of a vector: reverse each 128-bit lane, then swap the lanes
+__attribute__((target("avx2")))
+static inline __m256i reverse32(__m256i v) {
+    const __m256i reverse = _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+                                             15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    return _mm256_permute4x64_epi64(_mm256_shuffle_epi8(v, reverse), 0x4E);
+}
+
+__attribute__((target("avx2")))
+static int rangeAVX2(const unsigned char *data, size_t length, size_t lo, size_t hi) {
+    size_t i = lo;
+
+    for (; i + 64 <= hi; i += 64) { // 64 bytes from each end per iteration
+        __m256i front0 = _mm256_loadu_si256((const __m256i *)(data + i));
+        __m256i front1 = _mm256_loadu_si256((const __m256i *)(data + i + 32));
+        __m256i back0 = reverse32(_mm256_loadu_si256((const __m256i *)(data + length - i - 32)));
+        __m256i back1 = reverse32(_mm256_loadu_si256((const __m256i *)(data + length - i - 64)));
+        __m256i equal = _mm256_and_si256(_mm256_cmpeq_epi8(front0, back0), _mm256_cmpeq_epi8(front1, back1));
+        if (_mm256_movemask_epi8(equal) != -1) {
+            return 0;
+        }
+    }
+
+    for (; i + 32 <= hi; i += 32) {
+        __m256i front = _mm256_loadu_si256((const __m256i *)(data + i));
+        __m256i back = reverse32(_mm256_loadu_si256((const __m256i *)(data + length - i - 32)));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(front, back)) != -1) {
+            return 0;
+        }
+    }
+    return rangeScalar(data, length, i, hi);
+}
+#endif
+
+//------------------------------------------------------
+// folded (alphanumeric only, case-insensitive) kernels
+
+// Lower-cased letter or digit, -1 for anything else (ASCII only, like isalnum in the C locale)
+static inline int foldByte(unsigned char c) {
+    unsigned char lower = c | 0x20;
+    if ((unsigned char)(lower - 'a') <= 'z' - 'a') {
+        return lower;
+    }
+    if ((unsigned char)(c - '0') <= 9) {
+        return c;
+    }
+    return -1;
+}
+
+static void foldFrontScalar(const unsigned char *data, size_t *front, size_t *back, FoldBuffer *out) {
+    size_t i = *front, n = 0;
+
+    while (n < FOLD_BUFFER && i < *back) {
+        int folded = foldByte(data[i++]);
+        if (folded >= 0) {
+            out->chars[n++] = folded;
+        }
+    }
+    *front = i;
+    out->count = n;
+    out->pos = 0;
+}
+
+static void foldBackScalar(const unsigned char *data, size_t *front, size_t *back, FoldBuffer *out) {
+    size_t j = *back, n = 0;
+
+    while (n < FOLD_BUFFER && j > *front) {
+        int folded = foldByte(data[--j]);
+        if (folded >= 0) {
+            out->chars[n++] = folded;
+        }
+    }
+    *back = j;
+    out->count = n;
+    out->pos = 0;
+}
+
+#ifdef HAVE_X86_SIMD
+// For every 8-bit mask, the positions of its set bits (0x80 pads the rest so pshufb writes zeros)
+static unsigned char compactTable[256][8];
+
+static void initCompactTable(void) {
+    for (int mask = 0; mask < 256; mask++) {
+        int n = 0;
+        for (int bit = 0; bit < 8; bit++) {
+            if (mask & (1 << bit)) {
+                compactTable[mask][n++] = bit;
+            }
+        }
+        while (n < 8) {
+            compactTable[mask][n++] = 0x80;
+        }
+    }
+}
+
+// Store the bytes of v selected by mask contiguously at out, 8 bytes at a time through pshufb.
+// Writes up to 32 bytes; returns how many are valid.
+__attribute__((target("avx2")))
+static inline size_t compact32(__m256i v, unsigned mask, unsigned char *out) {
+    __m128i halves[2] = {_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)};
+    size_t n = 0;
+
+    for (int group = 0; group < 4; group++) {
+        __m128i bytes = group & 1 ? _mm_srli_si128(halves[group >> 1], 8) : halves[group >> 1];
+        unsigned bits = (mask >> (8 * group)) & 0xFF;
+        __m128i index = _mm_loadl_epi64((const __m128i *)compactTable[bits]);
+        _mm_storel_epi64((__m128i *)(out + n), _mm_shuffle_epi8(bytes, index));
+        n += __builtin_popcount(bits);
+    }
+    return n;
+}
+
+// Fold 32 bytes at once; returns the mask of alphanumeric bytes
+__attribute__((target("avx2")))
+static inline unsigned fold32(__m256i c, __m256i *folded) {
+    __m256i lower = _mm256_or_si256(c, _mm256_set1_epi8(0x20));
+    __m256i alpha = _mm256_sub_epi8(lower, _mm256_set1_epi8('a'));
+    __m256i digit = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+    __m256i isAlpha = _mm256_cmpeq_epi8(_mm256_min_epu8(alpha, _mm256_set1_epi8('z' - 'a')), alpha);
+    __m256i isDigit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+
+    *folded = _mm256_blendv_epi8(c, lower, isAlpha);
+    return (unsigned)_mm256_movemask_epi8(_mm256_or_si256(isAlpha, isDigit));
+}
+
+__attribute__((target("avx2")))
+static void foldFrontAVX2(const unsigned char *data, size_t *front, size_t *back, FoldBuffer *out) {
+    size_t i = *front, n = 0;
+
+    while (n + 32 <= FOLD_BUFFER && i + 32 <= *back) {
+        __m256i folded;
+        unsigned mask = fold32(_mm256_loadu_si256((const __m256i *)(data + i)), &folded);
+
+        if (mask == 0xFFFFFFFFu) { // All alphanumeric: store the whole block
+            _mm256_storeu_si256((__m256i *)(out->chars + n), folded);
+            n += 32;
+        } else if (mask) { // Compact the alphanumeric bytes in order
+            n += compact32(folded, mask, out->chars + n);
+        }
+        i += 32;
+    }
+
+    if (i + 32 > *back) { // Less than one block left before the other end
+        while (n < FOLD_BUFFER && i < *back) {
+            int folded = foldByte(data[i++]);
+            if (folded >= 0) {
+                out->chars[n++] = folded;
+            }
+        }
+    }
+    *front = i;
+    out->count = n;
+    out->pos = 0;
+}
+
+__attribute__((target("avx2")))
+static void foldBackAVX2(const unsigned char *data, size_t *front, size_t *back, FoldBuffer *out) {
+    size_t j = *back, n = 0;
+
+    while (n + 32 <= FOLD_BUFFER && j >= *front + 32) {
+        __m256i folded; // Reversed first, so the block is compacted from its last byte down
+        unsigned mask = fold32(reverse32(_mm256_loadu_si256((const __m256i *)(data + j - 32))), &folded);
+
+        if (mask == 0xFFFFFFFFu) { // All alphanumeric: store the whole block
+            _mm256_storeu_si256((__m256i *)(out->chars + n), folded);
+            n += 32;
+        } else if (mask) {
+            n += compact32(folded, mask, out->chars + n);
+        }
+        j -= 32;
+    }
+
+    if (j < *front + 32) { // Less than one block left before the other end
+        while (n < FOLD_BUFFER && j > *front) {
+            int folded = foldByte(data[--j]);
+            if (folded >= 0) {
+                out->chars[n++] = folded;
+            }
+        }
+    }
+    *back = j;
+    out->count = n;
+    out->pos = 0;
+}
+#endif
+
+//------------------------------------------------------
+// kernel selection
+
+static RangeKernel rangeKernel = rangeScalar;
+static FoldKernel foldFrontKernel = foldFrontScalar, foldBackKernel = foldBackScalar;
+static pthread_once_t kernelsOnce = PTHREAD_ONCE_INIT; // Callers may run on several threads at once
+
+// Pick the widest kernels the CPU supports, and fill the tables they need
+static void initKernels(void) {
+#ifdef HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        initCompactTable();
+        rangeKernel = rangeAVX2;
+        foldFrontKernel = foldFrontAVX2;
+        foldBackKernel = foldBackAVX2;
+    } else if (__builtin_cpu_supports("ssse3")) {
+        rangeKernel = rangeSSSE3;
+    }
+#endif
+}
+
+//------------------------------------------------------
+// public API
+
+static void *palindromeWorker(void *arg) {
+    PalindromeJob *job = arg;
+    size_t chunk;
+
+    while (!__atomic_load_n(&job->mismatch, __ATOMIC_RELAXED) &&
+           (chunk = __atomic_fetch_add(&job->nextChunk, 1, __ATOMIC_RELAXED)) * PALINDROME_CHUNK < job->half) {
+        size_t lo = chunk * PALINDROME_CHUNK;
+        size_t hi = job->half - lo < PALINDROME_CHUNK ? job->half : lo + PALINDROME_CHUNK;
+
+        if (!job->kernel(job->data, job->length, lo, hi)) {
+            __atomic_store_n(&job->mismatch, 1, __ATOMIC_RELAXED);
+        }
+    }
+    return NULL;
+}
+
+int isPalindromeRange(const char *data, size_t length, int threads) {
+    pthread_once(&kernelsOnce, initKernels);
+    PalindromeJob job = {(const unsigned char *)data, length, length / 2, 0, 0, rangeKernel};
+    size_t chunks = (job.half + PALINDROME_CHUNK - 1) / PALINDROME_CHUNK;
+
+    runWorkers(palindromeWorker, &job, 0, threads, chunks);
+    return !job.mismatch;
+}
+
+// Both ends are normalized into small buffers that are compared with memcmp. Every raw byte is
+// consumed by exactly one end, so once they meet, whatever is left unmatched in one buffer is the
+// middle of the normalized string and only has to be a palindrome itself.
+int isPalindromeFolded(const char *data, size_t length) {
+    const unsigned char *bytes = (const unsigned char *)data;
+    FoldBuffer front = {.count = 0, .pos = 0}, back = {.count = 0, .pos = 0};
+    size_t frontPos = 0, backPos = length;
+
+    pthread_once(&kernelsOnce, initKernels);
+    FoldKernel foldFront = foldFrontKernel, foldBack = foldBackKernel;
+
+    while (1) {
+        if (front.pos == front.count) {
+            foldFront(bytes, &frontPos, &backPos, &front);
+        }
+        if (back.pos == back.count) {
+            foldBack(bytes, &frontPos, &backPos, &back);
+        }
+
+        size_t frontLeft = front.count - front.pos, backLeft = back.count - back.pos;
+        if (frontLeft == 0 || backLeft == 0) {
+            FoldBuffer *rest = frontLeft ? &front : &back;
+            return palindromeBytes((const char *)rest->chars + rest->pos, rest->count - rest->pos);
+        }
+
+        size_t n = frontLeft < backLeft ? frontLeft : backLeft;
+        if (memcmp(front.chars + front.pos, back.chars + back.pos, n) != 0) {
+            return 0;
+        }
+        front.pos += n;
+        back.pos += n;
+    }
+}
+
+int isPalindromeFoldedScalar(const char *data, size_t length) {
+    const unsigned char *bytes = (const unsigned char *)data;
+    size_t left = 0, right = length;
+
+    while (1) {
+        int a = -1, b = -1;
+        while (left < right && (a = foldByte(bytes[left])) < 0) {
+            left++;
+        }
+        while (left < right && (b = foldByte(bytes[right - 1])) < 0) {
+            right--;
+        }
+        if (right - left < 2) {
+            return 1;
+        }
+        if (a != b) {
+            return 0;
+        }
+        left++;
+        right--;
+    }
+}
+
+int checkPalindromeFile(const char *path, int fold, int threads) {
+    MappedFile file;
+    if (mapFile(path, &file) < 0) {
+        return -1;
+    }
+
+    size_t length = file.length;
+    if (!fold) { // A trailing line break is not part of the sequence
+        while (length > 0 && (file.data[length - 1] == '\n' || file.data[length - 1] == '\r')) {
+            length--;
+        }
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int result = fold ? isPalindromeFolded(file.data, length) : isPalindromeRange(file.data, length, threads);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("\"%s\" is %sa palindrome.\n", strcmp(path, "-") == 0 ? "stdin" : path, result ? "" : "not ");
+    printf("Checked %.1f MB in %.3f ms (%.2f GB/s)\n", length / 1e6, seconds * 1e3,
+           seconds > 0 ? length / seconds / 1e9 : 0.0);
+
+    unmapFile(&file);
+    return result;
+}
@@ -0,0 +1,15 @@
+#ifndef Palindrome_H
+#define Palindrome_H
+
+#include <stddef.h>
+
+#define PALINDROME_CHUNK (1 << 20)  // Bytes of the first half handed to a thread at a time
+#define FOLD_BUFFER 4096            // Normalized characters buffered per side in folded mode
+
+// threads <= 0 means one thread per online CPU
+int isPalindromeRange(const char *data, size_t length, int threads); // exact bytes, vectorized
+int isPalindromeFolded(const char *data, size_t length); // alphanumeric only, case-insensitive, vectorized
+int isPalindromeFoldedScalar(const char *data, size_t length); // reference two-pointer version
+int checkPalindromeFile(const char *path, int fold, int threads); // prints the result and throughput, -1 on error
+
+#endif
@@ -0,0 +1,37 @@
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "workers.h"
+
+int workerCount(int threads, size_t units) {
+    if (threads <= 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (int)online : 1;
+    }
+    if ((size_t)threads > units) {
+        threads = units > 0 ? (int)units : 1;
+    }
+    return threads;
+}
+
+int runWorkers(WorkerFn fn, void *args, size_t stride, int threads, size_t units) {
+    threads = workerCount(threads, units);
+
+    pthread_t *workers = threads > 1 ? malloc((threads - 1) * sizeof(pthread_t)) : NULL;
+    int started = 0;
+
+    if (workers) {
+        while (started < threads - 1 &&
+               pthread_create(&workers[started], NULL, fn, (char *)args + (started + 1) * stride) == 0) {
+            started++;
+        }
+    }
+
+    fn(args);
+
+    for (int i = 0; i < started; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    free(workers);
+    return started + 1;
+}
@@ -0,0 +1,17 @@
+#ifndef Workers_H
+#define Workers_H
+
+#include <stddef.h>
+
+typedef void *(*WorkerFn)(void *arg);
+
+// Threads to use for `units` pieces of work: threads <= 0 means one per online CPU, never more than units (at least 1)
+int workerCount(int threads, size_t units);
+
+// Run fn on workerCount(threads, units) threads, the caller being the first. Thread i gets
+// (char *)args + i * stride, so stride 0 shares one argument. If threads cannot be started the
+// ones that did (at least the caller) do all the work, so fn must take units from a shared counter.
+// Returns the number of threads that ran.
+int runWorkers(WorkerFn fn, void *args, size_t stride, int threads, size_t units);
+
+#endif
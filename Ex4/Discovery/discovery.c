@@ -1,14 +1,30 @@
+#define _GNU_SOURCE // For sendmmsg, getifaddrs and the interface ioctls
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <netinet/ip.h>
 #include <netinet/ip_icmp.h>
+#include <netinet/if_ether.h>
+#include <net/ethernet.h>
+#include <net/if.h>
+#include <ifaddrs.h>
+#include <linux/if_packet.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
 #include "discovery.h"
 #include <sys/time.h>
 #include <getopt.h>
 
+// Result slot for one address of an ARP sweep
+struct arp_host {
+    unsigned char seen;                  // Set once a reply (or our own address) was recorded
+    unsigned char mac[ETH_ALEN];         // Hardware address from the ARP reply
+};
+
 /**
  * @brief Function to check if a host is active by sending an ICMP echo request.
  * @param ip The IP address of the target host.
@@ -103,6 +119,271 @@ unsigned short int calculate_checksum(void *data, unsigned int bytes) {
     return (~((unsigned short int)total_sum)); // Return the one's complement
 }
 
+/**
+ * @brief Find the local interface whose subnet contains the whole target range.
+ * @param net_ip The target network address (host byte order).
+ * @param subnet The target prefix length.
+ * @param ifname In: interface to restrict the search to (empty string for any).
+ *               Out: name of the matching interface (IFNAMSIZ bytes).
+ * @param src_addr Out: IPv4 address of the matching interface.
+ * @return 1 if the target is on-link, 0 otherwise.
+ */
+int find_onlink_interface(unsigned int net_ip, int subnet, char *ifname, struct in_addr *src_addr) {
+    struct ifaddrs *ifaddr;
+    if (getifaddrs(&ifaddr) < 0) {
+        perror("getifaddrs failed");
+        return 0;
+    }
+
+    int found = 0;
+    for (struct ifaddrs *ifa = ifaddr; ifa && !found; ifa = ifa->ifa_next) {
+        // Only IPv4 addresses on non-loopback interfaces that are up
+        if (!ifa->ifa_addr || !ifa->ifa_netmask || ifa->ifa_addr->sa_family != AF_INET) {
+            continue;
+        }
+        if ((ifa->ifa_flags & IFF_LOOPBACK) || !(ifa->ifa_flags & IFF_UP)) {
+            continue;
+        }
+        if (ifname[0] != '\0' && strcmp(ifname, ifa->ifa_name) != 0) {
+            continue;
+        }
+
+        struct in_addr local = ((struct sockaddr_in *)ifa->ifa_addr)->sin_addr;
+        unsigned int if_ip = ntohl(local.s_addr);
+        unsigned int if_mask = ntohl(((struct sockaddr_in *)ifa->ifa_netmask)->sin_addr.s_addr);
+        unsigned int target_mask = subnet == 0 ? 0 : 0xFFFFFFFFu << (32 - subnet);
+
+        // The target range must be at least as specific as the interface subnet and inside it
+        if ((target_mask & if_mask) == if_mask && (net_ip & if_mask) == (if_ip & if_mask)) {
+            strncpy(ifname, ifa->ifa_name, IFNAMSIZ - 1);
+            ifname[IFNAMSIZ - 1] = '\0';
+            *src_addr = local;
+            found = 1;
+        }
+    }
+
+    freeifaddrs(ifaddr);
+    return found;
+}
+
+/**
+ * @brief Record an ARP reply if it answers for an address inside the swept range.
+ * @param frame The received Ethernet frame.
+ * @param len Length of the frame in bytes.
+ * @param base_ip First address of the range (host byte order).
+ * @param host_count Number of addresses in the range.
+ * @param hosts Result slots, one per address in the range.
+ * @return 1 if a new host was recorded, 0 otherwise.
+ */
+static int record_arp_reply(const unsigned char *frame, ssize_t len, unsigned int base_ip,
+                            unsigned int host_count, struct arp_host *hosts) {
+    if (len < (ssize_t)(sizeof(struct ether_header) + sizeof(struct ether_arp))) {
+        return 0;
+    }
+
+    const struct ether_header *eth = (const struct ether_header *)frame;
+    const struct ether_arp *arp = (const struct ether_arp *)(frame + sizeof(struct ether_header));
+    if (ntohs(eth->ether_type) != ETHERTYPE_ARP || ntohs(arp->ea_hdr.ar_op) != ARPOP_REPLY) {
+        return 0;
+    }
+
+    unsigned int sender;
+    memcpy(&sender, arp->arp_spa, sizeof(sender));
+    unsigned int index = ntohl(sender) - base_ip; // Wraps to a huge value when below the range
+    if (index >= host_count || hosts[index].seen) {
+        return 0;
+    }
+
+    hosts[index].seen = 1;
+    memcpy(hosts[index].mac, arp->arp_sha, ETH_ALEN);
+    return 1;
+}
+
+/**
+ * @brief Read every ARP reply that is already queued on the socket.
+ * @return Number of new hosts recorded.
+ */
+static int drain_arp_replies(int sock, unsigned int base_ip, unsigned int host_count, struct arp_host *hosts) {
+    unsigned char frame[1514];
+    ssize_t len;
+    int found = 0;
+
+    while ((len = recv(sock, frame, sizeof(frame), MSG_DONTWAIT)) > 0) {
+        found += record_arp_reply(frame, len, base_ip, host_count, hosts);
+    }
+
+    return found;
+}
+
+/**
+ * @brief Sweep a directly attached subnet with broadcast ARP requests.
+ *
+ * Requests are built once, handed to the kernel ARP_BATCH at a time with sendmmsg(),
+ * and replies are collected between batches so the receive queue never overflows.
+ * Hosts that drop ICMP still answer ARP, and the reply carries their MAC address.
+ *
+ * @param ifname Interface the range is attached to.
+ * @param src_addr Our IPv4 address on that interface (used as the ARP sender).
+ * @param base_ip First address of the range (host byte order).
+ * @param host_count Number of addresses in the range.
+ * @return Number of active hosts, or -1 on failure.
+ */
+int arp_sweep(const char *ifname, struct in_addr src_addr, unsigned int base_ip, unsigned int host_count) {
+    // Create a packet socket that only sees ARP frames
+    int sock = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ARP));
+    if (sock < 0) {
+        perror("Socket creation failed");
+        return -1;
+    }
+
+    // Look up the interface index and hardware address
+    struct ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, ifname, IFNAMSIZ - 1);
+    if (ioctl(sock, SIOCGIFINDEX, &ifr) < 0) {
+        perror("SIOCGIFINDEX failed");
+        close(sock);
+        return -1;
+    }
+    int ifindex = ifr.ifr_ifindex;
+
+    if (ioctl(sock, SIOCGIFHWADDR, &ifr) < 0) {
+        perror("SIOCGIFHWADDR failed");
+        close(sock);
+        return -1;
+    }
+    unsigned char src_mac[ETH_ALEN];
+    memcpy(src_mac, ifr.ifr_hwaddr.sa_data, ETH_ALEN);
+
+    // Bind to the interface so both sends and receives stay on it
+    struct sockaddr_ll link_addr;
+    memset(&link_addr, 0, sizeof(link_addr));
+    link_addr.sll_family = AF_PACKET;
+    link_addr.sll_protocol = htons(ETH_P_ARP);
+    link_addr.sll_ifindex = ifindex;
+    if (bind(sock, (struct sockaddr *)&link_addr, sizeof(link_addr)) < 0) {
+        perror("Bind failed");
+        close(sock);
+        return -1;
+    }
+
+    struct arp_host *hosts = calloc(host_count, sizeof(*hosts));
+    if (!hosts) {
+        perror("Allocation failed");
+        close(sock);
+        return -1;
+    }
+
+    // Build one batch of broadcast "who-has" frames; only the target address changes later
+    static unsigned char frames[ARP_BATCH][ARP_FRAME_LEN];
+    struct iovec iov[ARP_BATCH];
+    struct mmsghdr msgs[ARP_BATCH];
+    memset(frames, 0, sizeof(frames));
+    memset(msgs, 0, sizeof(msgs));
+
+    for (int i = 0; i < ARP_BATCH; i++) {
+        struct ether_header *eth = (struct ether_header *)frames[i];
+        struct ether_arp *arp = (struct ether_arp *)(frames[i] + sizeof(struct ether_header));
+
+        memset(eth->ether_dhost, 0xFF, ETH_ALEN); // Broadcast
+        memcpy(eth->ether_shost, src_mac, ETH_ALEN);
+        eth->ether_type = htons(ETHERTYPE_ARP);
+
+        arp->ea_hdr.ar_hrd = htons(ARPHRD_ETHER);
+        arp->ea_hdr.ar_pro = htons(ETHERTYPE_IP);
+        arp->ea_hdr.ar_hln = ETH_ALEN;
+        arp->ea_hdr.ar_pln = 4;
+        arp->ea_hdr.ar_op = htons(ARPOP_REQUEST);
+        memcpy(arp->arp_sha, src_mac, ETH_ALEN);
+        memcpy(arp->arp_spa, &src_addr.s_addr, 4);
+
+        iov[i].iov_base = frames[i];
+        iov[i].iov_len = ARP_FRAME_LEN;
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    // Our own address never answers, so record it directly
+    unsigned int own_index = ntohl(src_addr.s_addr) - base_ip;
+    if (own_index < host_count) {
+        hosts[own_index].seen = 1;
+        memcpy(hosts[own_index].mac, src_mac, ETH_ALEN);
+    }
+
+    struct timeval start, end;
+    gettimeofday(&start, NULL);
+
+    // Send the requests in batches, draining replies in between
+    unsigned int first = host_count > 2 ? 1 : 0; // Exclude network and broadcast
+    unsigned int last = host_count > 2 ? host_count - 1 : host_count;
+    int found = 0;
+
+    for (unsigned int index = first; index < last;) {
+        int batch = 0;
+        for (; batch < ARP_BATCH && index < last; index++) {
+            if (index == own_index) {
+                continue;
+            }
+            struct ether_arp *arp = (struct ether_arp *)(frames[batch] + sizeof(struct ether_header));
+            unsigned int target = htonl(base_ip + index);
+            memcpy(arp->arp_tpa, &target, 4);
+            batch++;
+        }
+
+        // sendmmsg() may accept only part of the batch when the socket buffer is full
+        for (int sent = 0; sent < batch;) {
+            int ret = sendmmsg(sock, msgs + sent, batch - sent, 0);
+            if (ret < 0) {
+                if (errno == EINTR || errno == ENOBUFS) {
+                    continue;
+                }
+                perror("Sendmmsg failed");
+                free(hosts);
+                close(sock);
+                return -1;
+            }
+            sent += ret;
+        }
+
+        found += drain_arp_replies(sock, base_ip, host_count, hosts);
+    }
+
+    // Keep collecting late replies until the network has been quiet long enough
+    struct pollfd fds[1];
+    fds[0].fd = sock;
+    fds[0].events = POLLIN;
+    while (poll(fds, 1, ARP_WAIT_MS) > 0) {
+        found += drain_arp_replies(sock, base_ip, host_count, hosts);
+    }
+
+    gettimeofday(&end, NULL);
+
+    // Print the active hosts in address order
+    for (unsigned int index = 0; index < host_count; index++) {
+        if (!hosts[index].seen) {
+            continue;
+        }
+
+        struct in_addr current_addr;
+        current_addr.s_addr = htonl(base_ip + index);
+        char ip_str[INET_ADDRSTRLEN];
+        if (!inet_ntop(AF_INET, &current_addr, ip_str, INET_ADDRSTRLEN)) {
+            continue;
+        }
+
+        const unsigned char *mac = hosts[index].mac;
+        printf("%-15s %02x:%02x:%02x:%02x:%02x:%02x\n", ip_str,
+               mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    }
+
+    double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1000000.0;
+    printf("ARP sweep on %s: %d hosts replied in %.3f s\n", ifname, found, elapsed);
+
+    free(hosts);
+    close(sock);
+    return found + (own_index < host_count);
+}
+
 /**
  * @brief Main function to perform network scanning.
  * @param argc Number of command-line arguments.
@@ -112,10 +393,12 @@ unsigned short int calculate_checksum(void *data, unsigned int bytes) {
 int main(int argc, char *argv[]) {
     char *address = NULL; // Store the base network address
     int subnet = 0; // Store the subnet mask
+    int mode = MODE_AUTO; // Scan mode (ARP when on-link, ICMP otherwise)
+    char ifname[IFNAMSIZ] = ""; // Interface to sweep on (empty for auto-detect)
     int opt;
 
     // Parse command-line arguments
-    while ((opt = getopt(argc, argv, "a:c:")) != -1) {
+    while ((opt = getopt(argc, argv, "a:c:m:i:")) != -1) {
         switch (opt) {
             case 'a':
                 address = optarg; // Store the network address
@@ -123,8 +406,23 @@ int main(int argc, char *argv[]) {
             case 'c':
                 subnet = atoi(optarg); // Convert subnet mask to integer
                 break;
+            case 'm':
+                if (strcmp(optarg, "auto") == 0) {
+                    mode = MODE_AUTO;
+                } else if (strcmp(optarg, "icmp") == 0) {
+                    mode = MODE_ICMP;
+                } else if (strcmp(optarg, "arp") == 0) {
+                    mode = MODE_ARP;
+                } else {
+                    fprintf(stderr, "Error: Invalid mode. Use 'auto', 'icmp' or 'arp'.\n");
+                    return 1;
+                }
+                break;
+            case 'i':
+                strncpy(ifname, optarg, IFNAMSIZ - 1); // Restrict ARP mode to this interface
+                break;
             default:
-                fprintf(stderr, "Usage: %s -a <address> -c <subnet>\n", argv[0]);
+                fprintf(stderr, "Usage: %s -a <address> -c <subnet> [-m auto|icmp|arp] [-i <interface>]\n", argv[0]);
                 return 1;
         }
     }
@@ -142,13 +440,37 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
-    printf("Scanning network %s/%d:\n", address, subnet); // Print scan details
-
     // Calculate the total number of hosts in the subnet
     unsigned int host_count = 1 << (32 - subnet); // Total hosts in subnet
-    unsigned int base_ip = ntohl(base_addr.s_addr); // Convert base IP to host byte order
+    unsigned int net_mask = 0xFFFFFFFFu << (32 - subnet); // Prefix mask (subnet is 1..32 here)
+    unsigned int base_ip = ntohl(base_addr.s_addr) & net_mask; // Network address, even if a host address was given
+
+    char net_str[INET_ADDRSTRLEN];
+    base_addr.s_addr = htonl(base_ip);
+    inet_ntop(AF_INET, &base_addr, net_str, sizeof(net_str));
+    printf("Scanning network %s/%d:\n", net_str, subnet); // Print scan details
     unsigned int max_ip = base_ip + host_count; // Calculate max IP in range
 
+    // Directly attached subnets are swept with ARP, which is faster and also finds hosts that drop ICMP
+    if (mode != MODE_ICMP) {
+        struct in_addr src_addr;
+        int onlink = subnet >= ARP_MIN_PREFIX && find_onlink_interface(base_ip, subnet, ifname, &src_addr);
+
+        if (onlink) {
+            if (arp_sweep(ifname, src_addr, base_ip, host_count) < 0) {
+                return 1;
+            }
+            printf("Scan Complete!\n");
+            return 0;
+        }
+
+        if (mode == MODE_ARP) {
+            fprintf(stderr, "Error: %s/%d is not on-link (or larger than /%d), cannot use ARP.\n",
+                    net_str, subnet, ARP_MIN_PREFIX);
+            return 1;
+        }
+    }
+
     // Iterate through each IP address in the subnet
     for (unsigned int ip = base_ip + 1; ip < max_ip - 1; ip++) { // Exclude network and broadcast
         struct in_addr current_addr;
@@ -1,8 +1,24 @@
 #ifndef DISCOVERY_H
 #define DISCOVERY_H
 
+#include <netinet/in.h>
+#include <net/if.h>
+
+// Constants
+#define ARP_BATCH 256          // ARP requests handed to the kernel per sendmmsg() call
+#define ARP_WAIT_MS 500        // Time to keep collecting replies after the last request (in ms)
+#define ARP_MIN_PREFIX 16      // Largest sweep (smallest prefix) handled by ARP mode
+#define ARP_FRAME_LEN 60       // Minimum Ethernet frame size (without FCS)
+
+// Scan modes
+#define MODE_AUTO 0            // ARP when the target is on-link, ICMP otherwise
+#define MODE_ICMP 1            // Always use ICMP echo
+#define MODE_ARP 2             // Always use ARP (fails if the target is not on-link)
+
 // Function declarations
 unsigned short int calculate_checksum(void *data, unsigned int bytes);
 int is_host_active(const char *ip);
+int find_onlink_interface(unsigned int net_ip, int subnet, char *ifname, struct in_addr *src_addr);
+int arp_sweep(const char *ifname, struct in_addr src_addr, unsigned int base_ip, unsigned int host_count);
 
 #endif // DISCOVERY_H
@@ -1,3 +1,4 @@
+#define _GNU_SOURCE         // For sched_setaffinity and CPU_SET
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -5,6 +6,7 @@
 #include <netinet/in.h>     // For sockaddr_in
 #include <netinet/ip.h>     // For IP header
 #include <netinet/ip_icmp.h> // For ICMP header
+#include <netinet/icmp6.h>  // For ICMPv6 types
 #include <poll.h>           // For poll
 #include <errno.h>          // For error handling
 #include <sys/socket.h>     // For socket operations
@@ -13,11 +15,46 @@
 #include <signal.h>         // For signal handling
 #include <getopt.h>         // For getopt
 #include <math.h>           // For sqrt
+#include <time.h>           // For clock_gettime
+#include <fcntl.h>          // For fcntl (non-blocking socket)
+#include <sched.h>          // For sched_setaffinity
+#include <sys/mman.h>       // For mlockall
 #include "ping.h"           // Custom functions/constants
 
 // Global variables for statistics
 volatile int packets_sent = 0, packets_received = 0; // Packet counters
 volatile float rtt_min = 0, rtt_max = 0, rtt_sum = 0, rtt_squared_sum = 0; // Round-trip time metrics
+int low_latency = 0; // Low-latency mode flag (busy polling instead of poll())
+
+// Packet buffers and RTT samples live outside the loop so they are never re-zeroed or re-faulted
+static char send_buffer[BUFFER_SIZE];       // Outgoing ICMP packet
+static char reply_buffer[BUFFER_SIZE];      // Incoming reply packet
+static float rtt_samples[MAX_SAMPLES];      // Most recent RTTs, used for the latency distribution
+
+// Compare two RTT samples for qsort
+static int compare_rtt(const void *a, const void *b) {
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+// Print RTT percentiles of the recorded samples
+static void print_latency_distribution() {
+    int samples = packets_received < MAX_SAMPLES ? packets_received : MAX_SAMPLES;
+    if (samples == 0) {
+        return;
+    }
+
+    qsort(rtt_samples, samples, sizeof(rtt_samples[0]), compare_rtt); // Sort samples for percentiles
+
+    float p50 = rtt_samples[(int)(samples * 0.50)];
+    float p90 = rtt_samples[(int)(samples * 0.90)];
+    float p99 = rtt_samples[(int)(samples * 0.99)];
+    float p999 = rtt_samples[(int)(samples * 0.999)];
+
+    fprintf(stdout, "rtt distribution (%s, %d samples):\n", low_latency ? "low-latency" : "poll", samples);
+    fprintf(stdout, "  p50/p90/p99/p99.9 = %.3f/%.3f/%.3f/%.3f ms\n", p50, p90, p99, p999);
+    fprintf(stdout, "  jitter (p99 - p50) = %.3f ms\n", p99 - p50);
+}
 
 // Signal handler to print statistics when program is interrupted (Ctrl+C)
 void handle_sigint() {
@@ -28,9 +65,138 @@ void handle_sigint() {
     fprintf(stdout, "%d packets transmitted, %d received\n", packets_sent, packets_received);
     fprintf(stdout, "rtt min/avg/max/mdev = %.3f/%.3f/%.3f/%.3f ms\n", 
             rtt_min, rtt_avg, rtt_max, rtt_mdev);
+    print_latency_distribution();
     exit(0); // Exit program
 }
 
+// Milliseconds elapsed between two monotonic timestamps
+static float elapsed_ms(const struct timespec *start, const struct timespec *end) {
+    return ((end->tv_sec - start->tv_sec) * 1000.0) + ((end->tv_nsec - start->tv_nsec) / 1000000.0);
+}
+
+// Pin the process to one CPU so it is never migrated between packets
+static int pin_to_cpu(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) < 0) {
+        perror("sched_setaffinity");
+        return -1;
+    }
+    return 0;
+}
+
+// Prepare the process for low-latency mode: lock and pre-fault memory, busy-poll the socket
+static int setup_low_latency(int sock) {
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) < 0) { // Keep every page resident (no page faults in the loop)
+        perror("mlockall");
+        return -1;
+    }
+
+    // Touch the buffers once so their pages are faulted in before the first packet
+    memset(send_buffer, 0, sizeof(send_buffer));
+    memset(reply_buffer, 0, sizeof(reply_buffer));
+    memset(rtt_samples, 0, sizeof(rtt_samples));
+
+    int busy_poll = BUSY_POLL_USEC; // Let the kernel poll the device queue on receive
+    if (setsockopt(sock, SOL_SOCKET, SO_BUSY_POLL, &busy_poll, sizeof(busy_poll)) < 0) {
+        perror("setsockopt(SO_BUSY_POLL)"); // Not fatal: needs CAP_NET_ADMIN and driver support
+    }
+
+    int flags = fcntl(sock, F_GETFL, 0); // Non-blocking so recvfrom can be spun on
+    if (flags < 0 || fcntl(sock, F_SETFL, flags | O_NONBLOCK) < 0) {
+        perror("fcntl");
+        return -1;
+    }
+
+    return 0;
+}
+
+// Check that the packet in reply_buffer answers this request. IPv4 raw sockets deliver the IP header
+// as well; IPv6 raw sockets start at the ICMPv6 header. Loopback also hands us our own echo request,
+// and other ping processes' or earlier sequences' replies arrive on the same socket.
+static int is_echo_reply(ssize_t bytes, int type, const struct icmphdr *request) {
+    size_t offset = 0;
+    unsigned char reply_type = ICMP6_ECHO_REPLY;
+
+    if (type == 4) {
+        if (bytes < (ssize_t)sizeof(struct iphdr)) {
+            return 0;
+        }
+        offset = ((const struct iphdr *)reply_buffer)->ihl * 4; // Skip the IP header and its options
+        reply_type = ICMP_ECHOREPLY;
+    }
+    if (bytes < (ssize_t)(offset + sizeof(struct icmphdr))) {
+        return 0;
+    }
+
+    const struct icmphdr *reply = (const struct icmphdr *)(reply_buffer + offset);
+    return reply->type == reply_type && reply->un.echo.id == request->un.echo.id &&
+           reply->un.echo.sequence == request->un.echo.sequence;
+}
+
+// Wait for the matching reply with poll(). Returns bytes received, 0 on timeout, -1 on error.
+static ssize_t receive_reply_poll(int sock, struct pollfd *fds, int type, const struct icmphdr *request,
+                                  const struct timespec *start, struct timespec *end,
+                                  struct sockaddr_storage *source_address, socklen_t *src_len) {
+    int remaining = TIMEOUT;
+
+    while (1) {
+        int ret = poll(fds, 1, remaining);
+
+        if (ret == 0) { // Timeout
+            return 0;
+        } else if (ret < 0) { // Error in poll
+            perror("poll");
+            return -1;
+        }
+
+        if (!(fds[0].revents & POLLIN)) {
+            return -1;
+        }
+
+        *src_len = sizeof(*source_address);
+        ssize_t bytes = recvfrom(sock, reply_buffer, sizeof(reply_buffer), 0,
+                                 (struct sockaddr *)source_address, src_len);
+        clock_gettime(CLOCK_MONOTONIC, end); // Timestamp right after the receive
+        if (bytes <= 0) {
+            perror("recvfrom");
+            return -1;
+        }
+        if (is_echo_reply(bytes, type, request)) {
+            return bytes;
+        }
+
+        remaining = TIMEOUT - (int)elapsed_ms(start, end); // Not ours: keep waiting for the rest of the timeout
+        if (remaining <= 0) {
+            return 0;
+        }
+    }
+}
+
+// Spin on a non-blocking recvfrom until the matching reply arrives. Returns bytes received, 0 on timeout, -1 on error.
+static ssize_t receive_reply_spin(int sock, int type, const struct icmphdr *request,
+                                  const struct timespec *start, struct timespec *end,
+                                  struct sockaddr_storage *source_address, socklen_t *src_len) {
+    while (1) {
+        *src_len = sizeof(*source_address);
+        ssize_t bytes = recvfrom(sock, reply_buffer, sizeof(reply_buffer), 0,
+                                 (struct sockaddr *)source_address, src_len);
+        clock_gettime(CLOCK_MONOTONIC, end); // Timestamp right after the receive attempt
+
+        if (bytes > 0 && is_echo_reply(bytes, type, request)) {
+            return bytes;
+        }
+        if (bytes < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            perror("recvfrom");
+            return -1;
+        }
+        if (elapsed_ms(start, end) >= TIMEOUT) { // Timeout
+            return 0;
+        }
+    }
+}
+
 int main(int argc, char *argv[]) {
     // Register signal handler for Ctrl+C
     signal(SIGINT, handle_sigint);
@@ -41,9 +207,16 @@ int main(int argc, char *argv[]) {
     int type = 0;          // Address type (4 for IPv4, 6 for IPv6)
     int count = MAX_REQUESTS; // Number of packets to send (default: unlimited)
     int flood = 0;         // Flood mode flag
+    int cpu = -1;          // CPU to pin to (-1 for no pinning)
+
+    static struct option long_options[] = {
+        {"low-latency", no_argument, NULL, 'l'},
+        {"cpu", required_argument, NULL, 'p'},
+        {NULL, 0, NULL, 0}
+    };
 
     // Parse command-line arguments
-    while ((opt = getopt(argc, argv, "a:t:c:f")) != -1) {
+    while ((opt = getopt_long(argc, argv, "a:t:c:flp:", long_options, NULL)) != -1) {
         switch (opt) {
             case 'a':
                 address = optarg; // Store target address
@@ -68,8 +241,18 @@ int main(int argc, char *argv[]) {
             case 'f':
                 flood = 1; // Enable flood mode
                 break;
+            case 'l':
+                low_latency = 1; // Enable low-latency mode
+                break;
+            case 'p':
+                cpu = atoi(optarg); // CPU to pin to
+                if (cpu < 0) {
+                    fprintf(stderr, "Error: CPU must be a non-negative integer.\n");
+                    return 1;
+                }
+                break;
             default:
-                fprintf(stderr, "Usage: %s -a <address> -t <type> [-c <count>] [-f]\n", argv[0]);
+                fprintf(stderr, "Usage: %s -a <address> -t <type> [-c <count>] [-f] [-l|--low-latency] [-p|--cpu <cpu>]\n", argv[0]);
                 return 1;
         }
     }
@@ -116,9 +299,23 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
+    // Pinning applies to both modes, so runs with and without --low-latency compare like with like
+    if ((cpu >= 0 && pin_to_cpu(cpu) < 0) || (low_latency && setup_low_latency(sock) < 0)) {
+        close(sock);
+        return 1;
+    }
+
+    // Determine address length based on type
+    socklen_t addr_len;
+    if (type == 4) {
+        addr_len = sizeof(struct sockaddr_in);
+    } else {
+        addr_len = sizeof(struct sockaddr_in6);
+    }
+
     // Initialize ICMP header
     struct icmphdr icmp_header;
-    icmp_header.type = ICMP_ECHO; // ICMP Echo Request
+    icmp_header.type = type == 4 ? ICMP_ECHO : ICMP6_ECHO_REQUEST; // Echo Request (the kernel fills the ICMPv6 checksum)
     icmp_header.code = 0;         // No additional code
     icmp_header.un.echo.id = htons(getpid()); // Unique identifier
     int seq = 0; // Sequence number for ICMP packets
@@ -138,77 +335,61 @@ int main(int argc, char *argv[]) {
         packets_sent++; // Increment packet sent counter
 
         // Prepare ICMP packet
-        char buffer[BUFFER_SIZE] = {0};
         icmp_header.un.echo.sequence = htons(seq++); // Set sequence number
         icmp_header.checksum = 0; // Reset checksum
-        memcpy(buffer, &icmp_header, sizeof(icmp_header)); // Copy ICMP header to buffer
-        icmp_header.checksum = calculate_checksum(buffer, sizeof(icmp_header)); // Calculate checksum
-        ((struct icmphdr *)buffer)->checksum = icmp_header.checksum; // Set checksum
+        memcpy(send_buffer, &icmp_header, sizeof(icmp_header)); // Copy ICMP header to buffer
+        icmp_header.checksum = calculate_checksum(send_buffer, sizeof(icmp_header)); // Calculate checksum
+        ((struct icmphdr *)send_buffer)->checksum = icmp_header.checksum; // Set checksum
 
-        struct timeval start, end; // Track packet round-trip time
-        gettimeofday(&start, NULL);
-
-        // Determine address length based on type
-        size_t addr_len;
-        if (type == 4) {
-            addr_len = sizeof(struct sockaddr_in);
-        } else {
-            addr_len = sizeof(struct sockaddr_in6);
-        }
+        struct timespec start, end; // Track packet round-trip time
+        struct sockaddr_storage source_address; // Address of the reply source
+        socklen_t src_len = sizeof(source_address);
+        clock_gettime(CLOCK_MONOTONIC, &start);
 
         // Send the ICMP packet
-        if (sendto(sock, buffer, sizeof(icmp_header), 0, 
+        if (sendto(sock, send_buffer, sizeof(icmp_header), 0, 
                    (struct sockaddr *)&destination_address, addr_len) <= 0) {
             perror("sendto");
             continue;
         }
 
         // Wait for a response
-        int ret = poll(fds, 1, TIMEOUT);
+        ssize_t ret;
+        if (low_latency) {
+            ret = receive_reply_spin(sock, type, &icmp_header, &start, &end, &source_address, &src_len);
+        } else {
+            ret = receive_reply_poll(sock, fds, type, &icmp_header, &start, &end, &source_address, &src_len);
+        }
 
         if (ret == 0) { // Timeout
             fprintf(stderr, "Request timeout for icmp_seq %d\n", seq);
             continue;
-        } else if (ret < 0) { // Error in poll
-            perror("poll");
+        } else if (ret < 0) { // Error while receiving
             continue;
         }
 
         // Process incoming packet
-        if (fds[0].revents & POLLIN) {
-            char reply_buffer[BUFFER_SIZE]; // Buffer for reply packet
-            struct sockaddr_storage source_address; // Address of the reply source
-            socklen_t src_len = sizeof(source_address);
-
-            if (recvfrom(sock, reply_buffer, sizeof(reply_buffer), 0, 
-                         (struct sockaddr *)&source_address, &src_len) <= 0) {
-                perror("recvfrom");
-                continue;
-            }
-
-            gettimeofday(&end, NULL); // Record end time
-            float elapsed = ((end.tv_sec - start.tv_sec) * 1000.0) + 
-                            ((end.tv_usec - start.tv_usec) / 1000.0); // Calculate RTT
-            rtt_sum += elapsed; // Update RTT sum
-            rtt_squared_sum += elapsed * elapsed; // Update squared RTT sum
-
-            if (packets_received == 0 || elapsed < rtt_min) { // Update min RTT
-                rtt_min = elapsed;
-            }
-
-            if (elapsed > rtt_max) { // Update max RTT
-                rtt_max = elapsed;
-            }
-
-            packets_received++; // Increment received packet count
-
-            // Print reply details
-            fprintf(stdout, "%ld bytes from %s: icmp_seq=%d ttl=%d time=%.3f ms\n", 
-                    (long)(sizeof(icmp_header)), 
-                    address, ntohs(icmp_header.un.echo.sequence), 
-                    64, elapsed);
+        float elapsed = elapsed_ms(&start, &end); // Calculate RTT
+        rtt_samples[packets_received % MAX_SAMPLES] = elapsed; // Keep the sample for percentiles
+        rtt_sum += elapsed; // Update RTT sum
+        rtt_squared_sum += elapsed * elapsed; // Update squared RTT sum
+
+        if (packets_received == 0 || elapsed < rtt_min) { // Update min RTT
+            rtt_min = elapsed;
+        }
+
+        if (elapsed > rtt_max) { // Update max RTT
+            rtt_max = elapsed;
         }
 
+        packets_received++; // Increment received packet count
+
+        // Print reply details
+        fprintf(stdout, "%ld bytes from %s: icmp_seq=%d ttl=%d time=%.3f ms\n", 
+                (long)(sizeof(icmp_header)), 
+                address, ntohs(icmp_header.un.echo.sequence), 
+                64, elapsed);
+
         if (!flood) { // Add delay if flood mode is not enabled
             sleep(SLEEP_TIME);
         }
@@ -6,6 +6,8 @@
 #define SLEEP_TIME 1  // Sleep time between consecutive ping requests in seconds
 #define MAX_REQUESTS 0  // Maximum number of ping requests to send (0 means unlimited)
 #define MAX_RETRY 3  // Maximum number of retries in case of failure
+#define MAX_SAMPLES 100000  // Number of most recent RTT samples kept for the latency distribution
+#define BUSY_POLL_USEC 50  // SO_BUSY_POLL budget in microseconds for low-latency mode
 
 // Function declaration for calculating the checksum of ICMP packets
 unsigned short int calculate_checksum(void *data, unsigned int bytes);